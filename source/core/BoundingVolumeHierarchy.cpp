@@ -0,0 +1,414 @@
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/vector_relational.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t g_noParent{ std::numeric_limits< uint32_t >::max() };
+constexpr uint32_t g_binsCount{ 16U };
+constexpr uint32_t g_maxLeafItems{ 4U };
+constexpr uint32_t g_maxDepth{ 64U };     // deeper ranges become leaves, so traversals fit a fixed stack
+constexpr float g_traversalCost{ 1.0F }; // of visiting a node, relative to testing an item
+
+void extend( ve::Aabb& aabb, const ve::Aabb& other ) noexcept {
+    aabb.minimum = glm::min( aabb.minimum, other.minimum );
+    aabb.maximum = glm::max( aabb.maximum, other.maximum );
+}
+
+void extend( ve::Aabb& aabb, const glm::vec3& point ) noexcept {
+    aabb.minimum = glm::min( aabb.minimum, point );
+    aabb.maximum = glm::max( aabb.maximum, point );
+}
+
+bool isEmpty( const ve::Aabb& aabb ) noexcept {
+    return aabb.minimum.x > aabb.maximum.x || aabb.minimum.y > aabb.maximum.y || aabb.minimum.z > aabb.maximum.z;
+}
+
+float getSurfaceArea( const ve::Aabb& aabb ) noexcept {
+    if ( isEmpty( aabb ) )
+        return 0.0F;
+
+    const glm::vec3 size{ aabb.maximum - aabb.minimum };
+    return 2.0F * ( size.x * size.y + size.y * size.z + size.z * size.x );
+}
+
+uint32_t getBin( const float centroid, const float minimum, const float scale ) noexcept {
+    return std::min( static_cast< uint32_t >( ( centroid - minimum ) * scale ), g_binsCount - 1U );
+}
+
+// distance along the ray to where it enters the box, infinity when it misses it
+float intersectRay( const glm::vec3& minimum, const glm::vec3& maximum, const glm::vec3& origin,
+                    const glm::vec3& inverseDirection ) noexcept {
+    const glm::vec3 nearSlabs{ ( minimum - origin ) * inverseDirection };
+    const glm::vec3 farSlabs{ ( maximum - origin ) * inverseDirection };
+    const glm::vec3 entries{ glm::min( nearSlabs, farSlabs ) };
+    const glm::vec3 exits{ glm::max( nearSlabs, farSlabs ) };
+    const float entry{ std::max( std::max( entries.x, entries.y ), std::max( entries.z, 0.0F ) ) };
+    const float exit{ std::min( std::min( exits.x, exits.y ), exits.z ) };
+
+    return exit >= entry ? entry : std::numeric_limits< float >::infinity();
+}
+
+} // namespace
+
+namespace ve {
+
+ve::Aabb transformAabb( const ve::Aabb& aabb, const glm::mat4& transform ) noexcept {
+    if ( isEmpty( aabb ) )
+        return aabb;
+
+    // the half extent is carried by the absolute basis, which gives the tightest box around the moved corners
+    const glm::vec3 center{ ( aabb.minimum + aabb.maximum ) * 0.5F };
+    const glm::vec3 halfExtent{ ( aabb.maximum - aabb.minimum ) * 0.5F };
+    const glm::mat3 basis{ transform };
+    const glm::vec3 movedCenter{ transform * glm::vec4{ center, 1.0F } };
+    const glm::vec3 movedHalfExtent{ glm::abs( basis[ 0 ] ) * halfExtent.x + glm::abs( basis[ 1 ] ) * halfExtent.y +
+                                     glm::abs( basis[ 2 ] ) * halfExtent.z };
+
+    return ve::Aabb{ .minimum{ movedCenter - movedHalfExtent }, .maximum{ movedCenter + movedHalfExtent } };
+}
+
+void BoundingVolumeHierarchy::build( std::span< const ve::Aabb > itemBounds ) {
+    const auto itemsCount{ static_cast< uint32_t >( std::size( itemBounds ) ) };
+    m_itemBounds.assign( std::begin( itemBounds ), std::end( itemBounds ) );
+    m_items.resize( itemsCount );
+    std::iota( std::begin( m_items ), std::end( m_items ), 0U );
+    m_itemLeaves.assign( itemsCount, 0U );
+    m_nodes.clear();
+    m_parents.clear();
+    m_dirtyNodes.clear();
+    m_depth = 0U;
+    if ( itemsCount == 0U ) {
+        m_dirtyFlags.clear();
+        return;
+    }
+
+    std::vector< glm::vec3 > centroids( itemsCount );
+    std::ranges::transform( m_itemBounds, std::begin( centroids ),
+                            []( const ve::Aabb& bounds ) { return ( bounds.minimum + bounds.maximum ) * 0.5F; } );
+
+    m_nodes.reserve( 2U * itemsCount - 1U );
+    m_parents.reserve( 2U * itemsCount - 1U );
+    buildNode( 0U, itemsCount, g_noParent, 1U, centroids );
+    m_dirtyFlags.assign( std::size( m_nodes ), uint8_t{ 0U } );
+}
+
+uint32_t BoundingVolumeHierarchy::buildNode( const uint32_t begin, const uint32_t end, const uint32_t parent,
+                                             const uint32_t depth, std::span< const glm::vec3 > centroids ) {
+    const auto node{ static_cast< uint32_t >( std::size( m_nodes ) ) };
+    m_nodes.emplace_back();
+    m_parents.emplace_back( parent );
+    m_depth = std::max( m_depth, depth );
+
+    ve::Aabb bounds{};
+    ve::Aabb centroidBounds{};
+    for ( uint32_t index{ begin }; index < end; index++ ) {
+        extend( bounds, m_itemBounds[ m_items[ index ] ] );
+        extend( centroidBounds, centroids[ m_items[ index ] ] );
+    }
+    m_nodes[ node ].minimum = bounds.minimum;
+    m_nodes[ node ].maximum = bounds.maximum;
+
+    const uint32_t count{ end - begin };
+    if ( count == 1U || depth >= g_maxDepth ) {
+        makeLeaf( node, begin, end );
+        return node;
+    }
+
+    // items are binned by centroid along each axis, and the bin boundary with the lowest sum of child areas
+    // weighted by their item counts is the split
+    struct Bin {
+        ve::Aabb bounds{};
+        uint32_t count{};
+    };
+
+    const glm::vec3 extent{ centroidBounds.maximum - centroidBounds.minimum };
+    float bestCost{ std::numeric_limits< float >::max() };
+    glm::length_t bestAxis{ -1 };
+    uint32_t bestSplit{};
+    for ( glm::length_t axis{ 0 }; axis < 3; axis++ ) {
+        if ( extent[ axis ] <= 0.0F )
+            continue;
+
+        std::array< Bin, g_binsCount > bins{};
+        const float scale{ static_cast< float >( g_binsCount ) / extent[ axis ] };
+        for ( uint32_t index{ begin }; index < end; index++ ) {
+            const uint32_t item{ m_items[ index ] };
+            Bin& bin{ bins[ getBin( centroids[ item ][ axis ], centroidBounds.minimum[ axis ], scale ) ] };
+            extend( bin.bounds, m_itemBounds[ item ] );
+            bin.count++;
+        }
+
+        std::array< float, g_binsCount > rightCosts{};
+        std::array< uint32_t, g_binsCount > rightCounts{};
+        ve::Aabb rightBounds{};
+        uint32_t rightCount{};
+        for ( uint32_t split{ g_binsCount - 1U }; split > 0U; split-- ) {
+            extend( rightBounds, bins[ split ].bounds );
+            rightCount += bins[ split ].count;
+            rightCosts[ split ]  = static_cast< float >( rightCount ) * getSurfaceArea( rightBounds );
+            rightCounts[ split ] = rightCount;
+        }
+
+        ve::Aabb leftBounds{};
+        uint32_t leftCount{};
+        for ( uint32_t split{ 1U }; split < g_binsCount; split++ ) {
+            extend( leftBounds, bins[ split - 1U ].bounds );
+            leftCount += bins[ split - 1U ].count;
+            if ( leftCount == 0U || rightCounts[ split ] == 0U )
+                continue;
+
+            const float cost{ static_cast< float >( leftCount ) * getSurfaceArea( leftBounds ) + rightCosts[ split ] };
+            if ( cost < bestCost ) {
+                bestCost  = cost;
+                bestAxis  = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    const float leafCost{ static_cast< float >( count ) * getSurfaceArea( bounds ) };
+    const float splitCost{ g_traversalCost * getSurfaceArea( bounds ) + bestCost };
+    if ( count <= g_maxLeafItems && ( bestAxis < 0 || leafCost <= splitCost ) ) {
+        makeLeaf( node, begin, end );
+        return node;
+    }
+
+    // coincident centroids have no better split than halving the range
+    uint32_t middle{ begin + count / 2U };
+    if ( bestAxis >= 0 ) {
+        const float minimum{ centroidBounds.minimum[ bestAxis ] };
+        const float scale{ static_cast< float >( g_binsCount ) / extent[ bestAxis ] };
+        const auto first{ std::begin( m_items ) + begin };
+        const auto last{ std::begin( m_items ) + end };
+        const auto split{ std::partition(
+            first, last, [ &centroids, bestAxis, bestSplit, minimum, scale ]( const uint32_t item ) {
+                return getBin( centroids[ item ][ bestAxis ], minimum, scale ) < bestSplit;
+            } ) };
+        middle = begin + static_cast< uint32_t >( std::distance( first, split ) );
+    }
+
+    // the left child is built first, so it always directly follows its parent
+    buildNode( begin, middle, node, depth + 1U, centroids );
+    m_nodes[ node ].offset = buildNode( middle, end, node, depth + 1U, centroids );
+    m_nodes[ node ].count  = 0U;
+
+    return node;
+}
+
+void BoundingVolumeHierarchy::makeLeaf( const uint32_t node, const uint32_t begin, const uint32_t end ) {
+    m_nodes[ node ].offset = begin;
+    m_nodes[ node ].count  = end - begin;
+    for ( uint32_t index{ begin }; index < end; index++ )
+        m_itemLeaves[ m_items[ index ] ] = node;
+}
+
+void BoundingVolumeHierarchy::setItemBounds( const uint32_t item, const ve::Aabb& bounds ) noexcept {
+    m_itemBounds[ item ] = bounds;
+
+    // the path to the root is marked up to the first node already on the way of another moved item
+    for ( uint32_t node{ m_itemLeaves[ item ] }; node != g_noParent && m_dirtyFlags[ node ] == 0U;
+          node = m_parents[ node ] ) {
+        m_dirtyFlags[ node ] = 1U;
+        m_dirtyNodes.emplace_back( node );
+    }
+}
+
+size_t BoundingVolumeHierarchy::refit() {
+    // children are stored after their parents, so going down the indices refits them first
+    std::ranges::sort( m_dirtyNodes, std::ranges::greater{} );
+    for ( const uint32_t index : m_dirtyNodes ) {
+        Node& node{ m_nodes[ index ] };
+        ve::Aabb bounds{};
+        if ( node.isLeaf() ) {
+            bounds = getLeafBounds( node );
+        } else {
+            const Node& left{ m_nodes[ index + 1U ] };
+            const Node& right{ m_nodes[ node.offset ] };
+            bounds = ve::Aabb{ .minimum{ glm::min( left.minimum, right.minimum ) },
+                               .maximum{ glm::max( left.maximum, right.maximum ) } };
+        }
+
+        node.minimum          = bounds.minimum;
+        node.maximum          = bounds.maximum;
+        m_dirtyFlags[ index ] = 0U;
+    }
+
+    const size_t refittedCount{ std::size( m_dirtyNodes ) };
+    m_dirtyNodes.clear();
+    return refittedCount;
+}
+
+ve::Aabb BoundingVolumeHierarchy::getLeafBounds( const Node& node ) const noexcept {
+    ve::Aabb bounds{};
+    for ( const uint32_t item : std::span{ m_items }.subspan( node.offset, node.count ) )
+        extend( bounds, m_itemBounds[ item ] );
+
+    return bounds;
+}
+
+template < typename OverlapFunction >
+size_t BoundingVolumeHierarchy::query( OverlapFunction getOverlap, std::vector< uint32_t >& items ) const {
+    if ( m_nodes.empty() )
+        return 0U;
+
+    struct Entry {
+        uint32_t node{};
+        bool isInside{}; // an ancestor is inside, so the subtree is taken without tests
+    };
+
+    std::array< Entry, g_maxDepth + 1U > stack{};
+    size_t stackSize{};
+    size_t testedCount{};
+    stack[ stackSize++ ] = Entry{ 0U, false };
+    while ( stackSize > 0U ) {
+        const Entry entry{ stack[ --stackSize ] };
+        const Node& node{ m_nodes[ entry.node ] };
+        Overlap overlap{ Overlap::eInside };
+        if ( !entry.isInside ) {
+            testedCount++;
+            overlap = getOverlap( node.minimum, node.maximum );
+            if ( overlap == Overlap::eOutside )
+                continue;
+        }
+
+        if ( node.isLeaf() ) {
+            for ( const uint32_t item : std::span{ m_items }.subspan( node.offset, node.count ) ) {
+                if ( overlap != Overlap::eInside ) {
+                    testedCount++;
+                    const ve::Aabb& bounds{ m_itemBounds[ item ] };
+                    if ( getOverlap( bounds.minimum, bounds.maximum ) == Overlap::eOutside )
+                        continue;
+                }
+                items.emplace_back( item );
+            }
+            continue;
+        }
+
+        const bool isInside{ overlap == Overlap::eInside };
+        stack[ stackSize++ ] = Entry{ node.offset, isInside };
+        stack[ stackSize++ ] = Entry{ entry.node + 1U, isInside };
+    }
+
+    return testedCount;
+}
+
+size_t BoundingVolumeHierarchy::queryFrustum( const ve::Frustum& frustum, std::vector< uint32_t >& items ) const {
+    // a box is outside when its corner furthest along a plane normal is behind that plane, and inside when even its
+    // nearest corner is in front of all of them
+    return query(
+        [ &frustum ]( const glm::vec3& minimum, const glm::vec3& maximum ) {
+            Overlap overlap{ Overlap::eInside };
+            for ( const auto& plane : frustum.planes ) {
+                const glm::vec3 normal{ plane };
+                const glm::bvec3 isPositive{ glm::greaterThanEqual( normal, glm::vec3{ 0.0F } ) };
+                const glm::vec3 positive{ glm::mix( minimum, maximum, isPositive ) };
+                if ( glm::dot( normal, positive ) + plane.w < 0.0F )
+                    return Overlap::eOutside;
+
+                const glm::vec3 negative{ glm::mix( maximum, minimum, isPositive ) };
+                if ( glm::dot( normal, negative ) + plane.w < 0.0F )
+                    overlap = Overlap::eIntersecting;
+            }
+
+            return overlap;
+        },
+        items );
+}
+
+size_t BoundingVolumeHierarchy::querySphere( const glm::vec4& sphere, std::vector< uint32_t >& items ) const {
+    return query(
+        [ &sphere ]( const glm::vec3& minimum, const glm::vec3& maximum ) {
+            const glm::vec3 center{ sphere };
+            const float radiusSquared{ sphere.w * sphere.w };
+            const glm::vec3 nearest{ glm::clamp( center, minimum, maximum ) };
+            if ( glm::dot( nearest - center, nearest - center ) > radiusSquared )
+                return Overlap::eOutside;
+
+            const glm::vec3 farthest{ glm::max( glm::abs( minimum - center ), glm::abs( maximum - center ) ) };
+            return glm::dot( farthest, farthest ) <= radiusSquared ? Overlap::eInside : Overlap::eIntersecting;
+        },
+        items );
+}
+
+size_t BoundingVolumeHierarchy::queryAabb( const ve::Aabb& aabb, std::vector< uint32_t >& items ) const {
+    return query(
+        [ &aabb ]( const glm::vec3& minimum, const glm::vec3& maximum ) {
+            if ( glm::any( glm::greaterThan( minimum, aabb.maximum ) ) ||
+                 glm::any( glm::lessThan( maximum, aabb.minimum ) ) )
+                return Overlap::eOutside;
+
+            const bool isInside{ glm::all( glm::greaterThanEqual( minimum, aabb.minimum ) ) &&
+                                 glm::all( glm::lessThanEqual( maximum, aabb.maximum ) ) };
+            return isInside ? Overlap::eInside : Overlap::eIntersecting;
+        },
+        items );
+}
+
+std::optional< BoundingVolumeHierarchy::RayHit > BoundingVolumeHierarchy::queryRay( const glm::vec3& origin,
+                                                                                    const glm::vec3& direction,
+                                                                                    const float maxDistance ) const {
+    if ( m_nodes.empty() )
+        return std::nullopt;
+
+    struct Entry {
+        uint32_t node{};
+        float distance{};
+    };
+
+    // the nearer child is visited first, and subtrees entered beyond the nearest hit so far are skipped
+    const glm::vec3 inverseDirection{ 1.0F / direction };
+    std::optional< RayHit > hit;
+    float nearest{ maxDistance };
+    std::array< Entry, g_maxDepth + 1U > stack{};
+    size_t stackSize{};
+    const float rootDistance{ intersectRay( m_nodes.front().minimum, m_nodes.front().maximum, origin,
+                                            inverseDirection ) };
+    if ( rootDistance <= nearest )
+        stack[ stackSize++ ] = Entry{ 0U, rootDistance };
+
+    while ( stackSize > 0U ) {
+        const Entry entry{ stack[ --stackSize ] };
+        if ( entry.distance > nearest )
+            continue;
+
+        const Node& node{ m_nodes[ entry.node ] };
+        if ( node.isLeaf() ) {
+            for ( const uint32_t item : std::span{ m_items }.subspan( node.offset, node.count ) ) {
+                const ve::Aabb& bounds{ m_itemBounds[ item ] };
+                const float distance{ intersectRay( bounds.minimum, bounds.maximum, origin, inverseDirection ) };
+                if ( distance <= nearest ) {
+                    nearest = distance;
+                    hit     = RayHit{ .item{ item }, .distance{ distance } };
+                }
+            }
+            continue;
+        }
+
+        Entry nearChild{ entry.node + 1U, 0.0F };
+        Entry farChild{ node.offset, 0.0F };
+        nearChild.distance = intersectRay( m_nodes[ nearChild.node ].minimum, m_nodes[ nearChild.node ].maximum,
+                                           origin, inverseDirection );
+        farChild.distance  = intersectRay( m_nodes[ farChild.node ].minimum, m_nodes[ farChild.node ].maximum, origin,
+                                           inverseDirection );
+        if ( farChild.distance < nearChild.distance )
+            std::swap( nearChild, farChild );
+        if ( farChild.distance <= nearest )
+            stack[ stackSize++ ] = farChild;
+        if ( nearChild.distance <= nearest )
+            stack[ stackSize++ ] = nearChild;
+    }
+
+    return hit;
+}
+
+} // namespace ve
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Frustum.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ve {
+
+// Axis aligned box, empty by default so extending it with anything gives that thing.
+struct Aabb {
+    glm::vec3 minimum{ std::numeric_limits< float >::max() };
+    glm::vec3 maximum{ std::numeric_limits< float >::lowest() };
+};
+
+// box around the transformed corners of aabb
+ve::Aabb transformAabb( const ve::Aabb& aabb, const glm::mat4& transform ) noexcept;
+
+// Hierarchy of boxes over items identified by their index, built with the surface area heuristic. Nodes are stored
+// depth first in 32 bytes each, the left child right after its parent, so a traversal mostly walks forward in memory.
+// Moved items are refitted: only the boxes on their path to the root are recomputed, the topology is kept.
+class BoundingVolumeHierarchy {
+public:
+    struct RayHit {
+        uint32_t item{};
+        float distance{}; // along the ray to where it enters the item box
+    };
+
+    void build( std::span< const ve::Aabb > itemBounds );
+    void setItemBounds( const uint32_t item, const ve::Aabb& bounds ) noexcept;
+    // recomputes the boxes changed since the last refit, returns their number
+    size_t refit();
+
+    // overlap queries append the items whose boxes touch the volume and return the number of tested nodes
+    size_t queryFrustum( const ve::Frustum& frustum, std::vector< uint32_t >& items ) const;
+    size_t querySphere( const glm::vec4& sphere, std::vector< uint32_t >& items ) const;
+    size_t queryAabb( const ve::Aabb& aabb, std::vector< uint32_t >& items ) const;
+    // nearest item whose box the ray enters within maxDistance, direction does not have to be normalized
+    std::optional< RayHit > queryRay( const glm::vec3& origin, const glm::vec3& direction,
+                                      const float maxDistance = std::numeric_limits< float >::max() ) const;
+
+    size_t getNodesCount() const noexcept { return std::size( m_nodes ); }
+    size_t getItemsCount() const noexcept { return std::size( m_itemBounds ); }
+    uint32_t getDepth() const noexcept { return m_depth; }
+
+private:
+    struct Node {
+        glm::vec3 minimum{};
+        uint32_t offset{}; // right child of an inner node, first entry in m_items of a leaf
+        glm::vec3 maximum{};
+        uint32_t count{}; // items of a leaf, 0 for an inner node
+
+        bool isLeaf() const noexcept { return count != 0U; }
+    };
+    static_assert( sizeof( Node ) == 32U );
+
+    enum class Overlap { eOutside, eIntersecting, eInside };
+
+    std::vector< Node > m_nodes;
+    std::vector< uint32_t > m_items; // leaves reference consecutive ranges of it
+    std::vector< ve::Aabb > m_itemBounds;
+    std::vector< uint32_t > m_itemLeaves;
+    std::vector< uint32_t > m_parents;
+    std::vector< uint8_t > m_dirtyFlags;
+    std::vector< uint32_t > m_dirtyNodes;
+    uint32_t m_depth{};
+
+    uint32_t buildNode( const uint32_t begin, const uint32_t end, const uint32_t parent, const uint32_t depth,
+                        std::span< const glm::vec3 > centroids );
+    void makeLeaf( const uint32_t node, const uint32_t begin, const uint32_t end );
+    ve::Aabb getLeafBounds( const Node& node ) const noexcept;
+    template < typename OverlapFunction >
+    size_t query( OverlapFunction getOverlap, std::vector< uint32_t >& items ) const;
+};
+
+} // namespace ve
@@ -20,6 +20,10 @@ glm::mat4 Camera::getViewMartix() const {
     return glm::inverse( cameraTranslation * cameraRotation );
 }
 
+ve::Frustum Camera::getFrustum( const glm::mat4& projection, const glm::mat4& model ) const {
+    return ve::Frustum{ projection * getViewMartix() * model };
+}
+
 glm::mat4 Camera::getRotationMatrix() const {
     const glm::quat pitchRotation{ glm::angleAxis( m_pitch, glm::vec3{ 1.0F, 0.0F, 0.0F } ) };
     const glm::quat yawRotation{ glm::angleAxis( m_yaw, glm::vec3{ 0.0F, -1.0F, 0.0F } ) };
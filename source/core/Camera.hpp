@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Frustum.hpp"
+
 #include "utils/NonCopyable.hpp"
 #include "utils/NonMovable.hpp"
 
@@ -17,6 +19,8 @@ public:
     void processMouse( double xpos, double ypos, int button, int mode );
 
     glm::mat4 getViewMartix() const;
+    // frustum planes in the space model maps to the world from
+    ve::Frustum getFrustum( const glm::mat4& projection, const glm::mat4& model = glm::mat4{ 1.0F } ) const;
     glm::vec3 getPosition() const noexcept { return m_position; }
 
 private:
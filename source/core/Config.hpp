@@ -25,6 +25,7 @@ namespace cfg::directory {
 
 inline const std::filesystem::path shaderBinaries{ SHADER_BINARIES_DIR };
 inline const std::filesystem::path assets{ ASSETS_DIR };
+inline const std::filesystem::path sceneCache{ SCENE_CACHE_DIR };
 
 } // namespace cfg::directory
 
@@ -39,3 +40,48 @@ namespace cfg::device {
 inline constexpr uint32_t queueFamiliesCount{ 2U };
 
 } // namespace cfg::device
+
+namespace cfg::command {
+
+inline constexpr bool stateFiltering{ true }; // drop binds and push constants which repeat the bound state
+
+} // namespace cfg::command
+
+namespace cfg::upload {
+
+inline constexpr bool batchedTextureUploads{ true };
+inline constexpr uint64_t stagingChunkSize{ 64ULL * 1024ULL * 1024ULL };
+inline constexpr uint64_t stagingBudget{ 256ULL * 1024ULL * 1024ULL };
+
+} // namespace cfg::upload
+
+namespace cfg::texture {
+
+inline constexpr bool blockCompression{ true };
+inline constexpr bool mipStreaming{ true };
+inline constexpr uint32_t streamingTailSize{ 128U }; // largest mip kept resident whatever the screen coverage
+inline constexpr uint64_t streamingBudget{ 256ULL * 1024ULL * 1024ULL };
+
+} // namespace cfg::texture
+
+namespace cfg::geometry {
+
+inline constexpr bool packedVertices{ true };
+inline constexpr bool optimizeIndices{ true };
+inline constexpr bool reduceOverdraw{ true };
+inline constexpr bool shortIndices{ true };
+inline constexpr bool lods{ true };
+inline constexpr float lodErrorPixels{ 1.0F }; // largest on-screen deviation of a simplified surface
+inline constexpr bool frustumCulling{ true };
+inline constexpr bool boundingVolumeHierarchy{ true }; // culls through a BVH over the surfaces of each scene
+
+} // namespace cfg::geometry
+
+namespace cfg::loader {
+
+inline constexpr bool sceneCache{ true };
+inline constexpr uint32_t sceneCacheVersion{ 9U };
+inline constexpr bool streaming{ true };
+inline constexpr uint64_t streamingBytesPerFrame{ 32ULL * 1024ULL * 1024ULL };
+
+} // namespace cfg::loader
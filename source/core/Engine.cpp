@@ -1,6 +1,8 @@
 #include "Engine.hpp"
 #include "Config.hpp"
 
+#include "utils/RadixSort.hpp"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -8,6 +10,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
 #include <limits>
 #include <chrono>
 
@@ -27,6 +30,8 @@ Engine::Engine()
       m_graphicsCommandPool{ m_logicalDevice },
       m_immediateSubmitFence{ m_logicalDevice },
       m_immediateBuffer{ m_graphicsCommandPool.createCommandBuffers() },
+      m_uploadFence{ m_logicalDevice },
+      m_uploadCommandBuffer{ m_graphicsCommandPool.createCommandBuffers() },
       m_transferCommandPool{ m_logicalDevice },
       m_transferCommandBuffer{ m_transferCommandPool.createCommandBuffers() },
       m_descriptorSetLayout{ m_logicalDevice },
@@ -129,8 +134,12 @@ void Engine::draw( const uint32_t imageIndex ) {
                                   m_swapchain.getImageView( imageIndex ), m_depthBuffer->getImageView() );
 
     auto currentDescriptorSet{ currentFrame.descriptorSet };
-    drawScene( commandBuffer, currentDescriptorSet );
+    drawScene( commandBuffer, currentDescriptorSet, m_mainRenderContext.opaqueSurfaces );
+    drawScene( commandBuffer, currentDescriptorSet, m_mainRenderContext.maskedSurfaces );
     drawSkybox( commandBuffer, currentDescriptorSet );
+    // transparent surfaces do not write depth, so they blend over the sky and come last
+    drawScene( commandBuffer, currentDescriptorSet, m_mainRenderContext.transparentSurfaces );
+    m_drawStateStats = commandBuffer.getStateStats();
 
     commandBuffer.endRendering();
 
@@ -153,26 +162,30 @@ void Engine::draw( const uint32_t imageIndex ) {
     graphicsQueue.submit( submitInfo, currentFrame.renderFence.get() );
 }
 
-void Engine::drawScene( const ve::GraphicsCommandBuffer currentCommandBuffer,
-                        const vk::DescriptorSet currentGlobalSet ) {
-    auto draw{ [ &currentCommandBuffer, &currentGlobalSet ]( const auto& renderObject ) {
-        currentCommandBuffer.bindPipeline( renderObject.material.pipeline.get() );
-        currentCommandBuffer.bindDescriptorSet( renderObject.material.pipeline.getLayout(), currentGlobalSet, 0U );
-        currentCommandBuffer.bindDescriptorSet( renderObject.material.pipeline.getLayout(),
-                                                renderObject.material.descriptorSet, 1U );
-        currentCommandBuffer.bindIndexBuffer( renderObject.indexBuffer );
+void Engine::drawScene( const ve::GraphicsCommandBuffer currentCommandBuffer, const vk::DescriptorSet currentGlobalSet,
+                        std::span< const ve::VisibleObject > surfaces ) {
+    // the command buffer drops the binds repeating its state, sorted draws mostly only push their constants
+    auto draw{ [ &currentCommandBuffer, &currentGlobalSet ]( const ve::VisibleObject& visibleObject ) {
+        const ve::RenderObject& renderObject{ *visibleObject.object };
+        const ve::Material& material{ renderObject.getMaterial() };
+        currentCommandBuffer.bindPipeline( material.pipeline.get() );
+        currentCommandBuffer.bindDescriptorSet( material.pipeline.getLayout(), currentGlobalSet, 0U );
+        currentCommandBuffer.bindDescriptorSet( material.pipeline.getLayout(), material.descriptorSet, 1U );
+        currentCommandBuffer.bindIndexBuffer( renderObject.indexBuffer, renderObject.indexType,
+                                              renderObject.indexBufferOffset );
 
         const ve::PushConstants pushConstants{ .worldMatrix{ renderObject.transform },
-                                               .vertexBufferAddress{ renderObject.vertexBufferAddress } };
-        currentCommandBuffer.pushConstants( renderObject.material.pipeline.getLayout(),
-                                            vk::ShaderStageFlagBits::eVertex, pushConstants );
-        currentCommandBuffer.drawIndices( renderObject.firstIndex, renderObject.indexCount );
+                                               .positionOffset{ renderObject.positionOffset },
+                                               .positionScale{ renderObject.positionScale },
+                                               .vertexBufferAddress{ renderObject.vertexBufferAddress },
+                                               .instanceBufferAddress{ renderObject.instanceBufferAddress } };
+        currentCommandBuffer.pushConstants( material.pipeline.getLayout(), vk::ShaderStageFlagBits::eVertex,
+                                            pushConstants );
+        currentCommandBuffer.drawIndices( visibleObject.firstIndex, visibleObject.indexCount,
+                                          renderObject.instanceCount );
     } };
 
-    std::ranges::for_each( m_mainRenderContext.opaqueSurfaces,
-                           [ &draw ]( const auto& renderObject ) { draw( renderObject ); } );
-    std::ranges::for_each( m_mainRenderContext.transparentSurfaces,
-                           [ &draw ]( const auto& renderObject ) { draw( renderObject ); } );
+    std::ranges::for_each( surfaces, draw );
 }
 
 void Engine::drawSkybox( const ve::GraphicsCommandBuffer currentCommandBuffer,
@@ -253,30 +266,44 @@ void Engine::configureDescriptorSets() {
     } );
 }
 
-MeshBuffers Engine::uploadMeshBuffers( std::span< Vertex > vertices, std::span< uint32_t > indices ) const {
+MeshBuffers Engine::uploadMeshBuffers( std::span< const std::byte > vertexData, std::span< const uint32_t > indices,
+                                       std::span< const uint16_t > shortIndices,
+                                       std::span< const glm::mat4 > instanceTransforms ) const {
     const auto logicalDeviceVk{ m_logicalDevice.get() };
     const auto commandBufferVk{ m_transferCommandBuffer.get() };
 
-    MeshBuffers newMeshBuffers;
-    newMeshBuffers.vertexBuffer.emplace( m_memoryAllocator, std::size( vertices ) * sizeof( Vertex ) );
-    newMeshBuffers.indexBuffer.emplace( m_memoryAllocator, std::size( indices ) * sizeof( uint32_t ) );
-
-    if ( newMeshBuffers.vertexBuffer.has_value() ) {
+    const auto getBufferAddress{ [ &logicalDeviceVk ]( const vk::Buffer buffer ) {
         vk::BufferDeviceAddressInfo addressInfo{};
-        addressInfo.sType                  = vk::StructureType::eBufferDeviceAddressInfo;
-        addressInfo.buffer                 = newMeshBuffers.vertexBuffer->get();
-        newMeshBuffers.vertexBufferAddress = logicalDeviceVk.getBufferAddress( addressInfo );
-    } else {
-        throw std::runtime_error( "failed to obtain buffer address" );
-    }
+        addressInfo.sType  = vk::StructureType::eBufferDeviceAddressInfo;
+        addressInfo.buffer = buffer;
+        return logicalDeviceVk.getBufferAddress( addressInfo );
+    } };
 
-    const vk::DeviceSize vertexBufferSize{ std::size( vertices ) * sizeof( Vertex ) };
-    const vk::DeviceSize indexBufferSize{ std::size( indices ) * sizeof( uint32_t ) };
+    MeshBuffers newMeshBuffers;
+    newMeshBuffers.vertexBuffer.emplace( m_memoryAllocator, std::size( vertexData ) );
+    newMeshBuffers.shortIndexOffset = std::size( indices ) * sizeof( uint32_t );
+    newMeshBuffers.indexBuffer.emplace( m_memoryAllocator, newMeshBuffers.shortIndexOffset +
+                                                               std::size( shortIndices ) * sizeof( uint16_t ) );
+    newMeshBuffers.vertexBufferAddress = getBufferAddress( newMeshBuffers.vertexBuffer->get() );
+
+    const vk::DeviceSize vertexBufferSize{ std::size( vertexData ) };
+    const vk::DeviceSize indexBufferSize{ newMeshBuffers.shortIndexOffset +
+                                          std::size( shortIndices ) * sizeof( uint16_t ) };
+    const vk::DeviceSize instanceBufferSize{ std::size( instanceTransforms ) * sizeof( glm::mat4 ) };
+
+    if ( instanceBufferSize != 0U ) {
+        newMeshBuffers.instanceBuffer.emplace( m_memoryAllocator, instanceBufferSize );
+        newMeshBuffers.instanceBufferAddress = getBufferAddress( newMeshBuffers.instanceBuffer->get() );
+    }
 
-    StagingBuffer stagingBuffer{ m_memoryAllocator, vertexBufferSize + indexBufferSize };
+    StagingBuffer stagingBuffer{ m_memoryAllocator, vertexBufferSize + indexBufferSize + instanceBufferSize };
     void *mappedMemory{ stagingBuffer.getMappedMemory() };
-    memcpy( mappedMemory, std::data( vertices ), vertexBufferSize );
-    memcpy( static_cast< char * >( mappedMemory ) + vertexBufferSize, std::data( indices ), indexBufferSize );
+    memcpy( mappedMemory, std::data( vertexData ), vertexBufferSize );
+    char *mappedIndices{ static_cast< char * >( mappedMemory ) + vertexBufferSize };
+    memcpy( mappedIndices, std::data( indices ), std::size( indices ) * sizeof( uint32_t ) );
+    memcpy( mappedIndices + newMeshBuffers.shortIndexOffset, std::data( shortIndices ),
+            std::size( shortIndices ) * sizeof( uint16_t ) );
+    memcpy( mappedIndices + indexBufferSize, std::data( instanceTransforms ), instanceBufferSize );
 
     logicalDeviceVk.resetFences( m_immediateSubmitFence.get() );
     m_transferCommandBuffer.reset();
@@ -293,6 +320,13 @@ MeshBuffers Engine::uploadMeshBuffers( std::span< Vertex > vertices, std::span<
     m_transferCommandBuffer.copyBuffer( indexSrcOffset, indexDstOffset, indexBufferSize, stagingBuffer.get(),
                                         newMeshBuffers.indexBuffer->get() );
 
+    if ( newMeshBuffers.instanceBuffer.has_value() ) {
+        const vk::DeviceSize instanceSrcOffset{ vertexBufferSize + indexBufferSize };
+        constexpr vk::DeviceSize instanceDstOffset{ 0U };
+        m_transferCommandBuffer.copyBuffer( instanceSrcOffset, instanceDstOffset, instanceBufferSize,
+                                            stagingBuffer.get(), newMeshBuffers.instanceBuffer->get() );
+    }
+
     m_transferCommandBuffer.end();
 
     vk::SubmitInfo submitInfo{};
@@ -344,9 +378,7 @@ void Engine::createDefaultTextureSampler() {
 }
 
 void Engine::loadMeshes() {
-    const auto sponza{ m_loader.load( cfg::directory::assets / "sponza/Sponza.gltf" ) };
-    if ( sponza.has_value() )
-        m_scene.emplace( "sponza", sponza.value() );
+    m_scene.emplace( "sponza", m_loader.load( cfg::directory::assets / "sponza/Sponza.gltf" ) );
 }
 
 void Engine::handleWindowResising() {
@@ -378,7 +410,17 @@ void Engine::immediateSubmit( const std::function< void( ve::GraphicsCommandBuff
 
 void Engine::updateScene( float deltaTime ) {
     m_mainRenderContext.opaqueSurfaces.clear();
+    m_mainRenderContext.maskedSurfaces.clear();
     m_mainRenderContext.transparentSurfaces.clear();
+    m_mainRenderContext.trianglesCount           = 0U;
+    m_mainRenderContext.fullDetailTrianglesCount = 0U;
+    m_mainRenderContext.updatedTransformsCount   = 0U;
+    m_mainRenderContext.visibleSurfacesCount     = 0U;
+    m_mainRenderContext.culledSurfacesCount      = 0U;
+    m_mainRenderContext.cullingTestsCount        = 0U;
+    m_mainRenderContext.refittedNodesCount       = 0U;
+    m_mainRenderContext.sceneIndex               = 0U;
+    m_loader.update();
 
     if ( m_camera != nullptr ) {
         m_camera->update( deltaTime );
@@ -400,8 +442,55 @@ void Engine::updateScene( float deltaTime ) {
 
     m_sceneData.projection[ 1 ][ 1 ] *= -1;
 
-    std::ranges::for_each( m_scene | std::views::values,
-                           [ this ]( auto& object ) { object->render( glm::mat4{ 1.0F }, m_mainRenderContext ); } );
+    // screen coverage feedback for texture streaming
+    m_mainRenderContext.viewMatrix      = m_sceneData.view * m_sceneData.model;
+    m_mainRenderContext.projectionScale = 0.5F * static_cast< float >( extent.height ) *
+                                          std::abs( m_sceneData.projection[ 1 ][ 1 ] );
+    m_mainRenderContext.frustum         = m_camera != nullptr
+                                              ? m_camera->getFrustum( m_sceneData.projection, m_sceneData.model )
+                                              : ve::Frustum{ m_sceneData.projection * m_mainRenderContext.viewMatrix };
+
+    std::ranges::for_each( m_scene | std::views::values, [ this ]( auto& object ) {
+        object->render( glm::mat4{ 1.0F }, m_mainRenderContext );
+        m_mainRenderContext.sceneIndex++;
+    } );
+
+    static constexpr float statsInterval{ 1000.0F };
+    m_statsTime += deltaTime;
+    const bool isStatsFrame{ m_statsTime >= statsInterval };
+
+    // opaque and masked draws are grouped by pipeline and material, and go front to back within a material;
+    // transparent ones go back to front
+    auto& opaqueSurfaces{ m_mainRenderContext.opaqueSurfaces };
+    const ve::StateChanges unsortedChanges{ isStatsFrame ? ve::countStateChanges( opaqueSurfaces )
+                                                         : ve::StateChanges{} };
+    const auto getSortKey{ []( const ve::VisibleObject& visibleObject ) { return visibleObject.sortKey; } };
+    ve::utils::radixSort( opaqueSurfaces, m_sortScratch, getSortKey );
+    ve::utils::radixSort( m_mainRenderContext.maskedSurfaces, m_sortScratch, getSortKey );
+    ve::utils::radixSort( m_mainRenderContext.transparentSurfaces, m_sortScratch, getSortKey );
+
+    if ( isStatsFrame ) {
+        m_statsTime = 0.0F;
+        const auto fullDetailCount{ std::max( m_mainRenderContext.fullDetailTrianglesCount, uint64_t{ 1U } ) };
+        spdlog::info( "Drawn triangles: {} of {} at full detail ({:.1f}%)", m_mainRenderContext.trianglesCount,
+                      m_mainRenderContext.fullDetailTrianglesCount,
+                      100.0F * static_cast< float >( m_mainRenderContext.trianglesCount ) /
+                          static_cast< float >( fullDetailCount ) );
+        spdlog::info( "Updated world transforms: {}", m_mainRenderContext.updatedTransformsCount );
+        spdlog::info( "Frustum culling: {} visible, {} culled surfaces, {} bounds tested",
+                      m_mainRenderContext.visibleSurfacesCount, m_mainRenderContext.culledSurfacesCount,
+                      m_mainRenderContext.cullingTestsCount );
+        spdlog::info( "BVH refitted nodes: {}", m_mainRenderContext.refittedNodesCount );
+
+        const ve::StateChanges sortedChanges{ ve::countStateChanges( opaqueSurfaces ) };
+        spdlog::info( "Opaque state changes for {} draws: pipelines {} -> {}, descriptor sets {} -> {}, index buffers "
+                      "{} -> {}",
+                      std::size( opaqueSurfaces ), unsortedChanges.pipelines, sortedChanges.pipelines,
+                      unsortedChanges.descriptorSets, sortedChanges.descriptorSets, unsortedChanges.indexBuffers,
+                      sortedChanges.indexBuffers );
+        spdlog::info( "Command buffer binds: {} issued, {} skipped as redundant", m_drawStateStats.issuedBinds,
+                      m_drawStateStats.skippedBinds );
+    }
 }
 
 void Engine::initDefaultData() {
@@ -430,7 +519,7 @@ void Engine::initDefaultData() {
         m_metalRough.writeMaterial( ve::Material::Type::eMainColor, m_defaultResources, m_globalDescriptorAllocator ) );
 }
 
-ve::Image Engine::createImage( void *data, const vk::Extent2D size, const vk::Format format,
+ve::Image Engine::createImage( const void *data, const vk::Extent2D size, const vk::Format format,
                                const vk::ImageUsageFlags usage, const uint32_t mipLevels ) {
     const auto& [ width, height ]{ size };
     const vk::DeviceSize bufferSize{ static_cast< vk::DeviceSize >( width ) * height * 4 };
@@ -452,6 +541,10 @@ ve::Image Engine::createImage( void *data, const vk::Extent2D size, const vk::Fo
     return image;
 }
 
+ve::UploadBatch Engine::createUploadBatch() const {
+    return ve::UploadBatch{ m_memoryAllocator, m_logicalDevice, m_uploadCommandBuffer, m_uploadFence };
+}
+
 void Engine::generateMipmaps( const ve::Image& image, const int32_t texWidth, const int32_t texHeight,
                               const uint32_t mipLevels ) {
     const auto formatProperties{ m_physicalDevice.get().getFormatProperties( image.getFormat() ) };
@@ -460,78 +553,9 @@ void Engine::generateMipmaps( const ve::Image& image, const int32_t texWidth, co
         return;
     }
 
-    immediateSubmit( [ & ]( ve::GraphicsCommandBuffer cmd ) {
-        const auto imageVk{ image.get() };
-        const auto bufferVk{ cmd.get() };
-
-        vk::ImageMemoryBarrier barrier{};
-        barrier.image                           = imageVk;
-        barrier.srcQueueFamilyIndex             = vk::QueueFamilyIgnored;
-        barrier.dstQueueFamilyIndex             = vk::QueueFamilyIgnored;
-        barrier.subresourceRange.aspectMask     = vk::ImageAspectFlagBits::eColor;
-        barrier.subresourceRange.baseArrayLayer = 0U;
-        barrier.subresourceRange.layerCount     = 1U;
-        barrier.subresourceRange.levelCount     = 1U;
-
-        int32_t mipWidth{ texWidth };
-        int32_t mipHeight{ texHeight };
-        vk::Offset3D destinationMipmapSize{};
-        static constexpr int offsetStartID{ 0 };
-        static constexpr int offsetEndID{ 1 };
-
-        for ( uint32_t mipLevel{ 1 }; mipLevel < mipLevels; ++mipLevel ) {
-            barrier.subresourceRange.baseMipLevel = mipLevel - 1U;
-            barrier.oldLayout                     = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout                     = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.srcAccessMask                 = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask                 = vk::AccessFlagBits::eTransferRead;
-
-            bufferVk.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-                                      vk::DependencyFlags{}, nullptr, nullptr, barrier );
-
-            vk::ImageBlit blit{};
-            blit.srcOffsets.at( offsetStartID ) = vk::Offset3D{ 0, 0, 0 };
-            blit.srcOffsets.at( offsetEndID )   = vk::Offset3D{ mipWidth, mipHeight, 1 };
-            blit.srcSubresource.aspectMask      = vk::ImageAspectFlagBits::eColor;
-            blit.srcSubresource.mipLevel        = mipLevel - 1U;
-            blit.srcSubresource.baseArrayLayer  = 0U;
-            blit.srcSubresource.layerCount      = 1U;
-
-            destinationMipmapSize =
-                vk::Offset3D{ mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-
-            blit.dstOffsets.at( offsetStartID ) = vk::Offset3D{ 0, 0, 0 };
-            blit.dstOffsets.at( offsetEndID )   = destinationMipmapSize;
-            blit.dstSubresource.aspectMask      = vk::ImageAspectFlagBits::eColor;
-            blit.dstSubresource.mipLevel        = mipLevel;
-            blit.dstSubresource.baseArrayLayer  = 0U;
-            blit.dstSubresource.layerCount      = 1U;
-
-            bufferVk.blitImage( imageVk, vk::ImageLayout::eTransferSrcOptimal, imageVk,
-                                vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear );
-
-            barrier.oldLayout     = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.newLayout     = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-            bufferVk.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
-                                      vk::DependencyFlags{}, nullptr, nullptr, barrier );
-
-            if ( mipWidth > 1 )
-                mipWidth /= 2;
-            if ( mipHeight > 1 )
-                mipHeight /= 2;
-        }
-
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout                     = vk::ImageLayout::eTransferDstOptimal;
-        barrier.newLayout                     = vk::ImageLayout::eShaderReadOnlyOptimal;
-        barrier.srcAccessMask                 = vk::AccessFlagBits::eTransferWrite;
-        barrier.dstAccessMask                 = vk::AccessFlagBits::eShaderRead;
-
-        bufferVk.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
-                                  vk::DependencyFlags{}, nullptr, nullptr, barrier );
+    const vk::Extent2D extent{ static_cast< uint32_t >( texWidth ), static_cast< uint32_t >( texHeight ) };
+    immediateSubmit( [ &image, extent, mipLevels ]( ve::GraphicsCommandBuffer cmd ) {
+        cmd.generateMipmaps( image.get(), extent, mipLevels );
     } );
 }
 
@@ -16,6 +16,7 @@
 #include "Node.hpp"
 #include "Camera.hpp"
 #include "ShaderModule.hpp"
+#include "UploadBatch.hpp"
 
 #include "command/CommandPool.hpp"
 #include "command/GraphicsCommandBuffer.hpp"
@@ -34,9 +35,12 @@ public:
     void init();
     void run();
 
-    MeshBuffers uploadMeshBuffers( std::span< Vertex > vertices, std::span< uint32_t > indices ) const;
-    ve::Image createImage( void *data, const vk::Extent2D size, const vk::Format format,
+    MeshBuffers uploadMeshBuffers( std::span< const std::byte > vertexData, std::span< const uint32_t > indices,
+                                   std::span< const uint16_t > shortIndices        = {},
+                                   std::span< const glm::mat4 > instanceTransforms = {} ) const;
+    ve::Image createImage( const void *data, const vk::Extent2D size, const vk::Format format,
                            const vk::ImageUsageFlags usage, const uint32_t mipLevels = 1U );
+    ve::UploadBatch createUploadBatch() const;
 
     const ve::LogicalDevice& getLogicalDevice() const noexcept { return m_logicalDevice; }
     const ve::Image& getDefaultImage() const noexcept { return m_defaultWhiteImage.value(); }
@@ -72,6 +76,8 @@ private:
     ve::CommandPool< ve::GraphicsCommandBuffer > m_graphicsCommandPool;
     ve::Fence m_immediateSubmitFence;
     ve::GraphicsCommandBuffer m_immediateBuffer;
+    ve::Fence m_uploadFence;
+    ve::GraphicsCommandBuffer m_uploadCommandBuffer;
     ve::CommandPool< ve::TransferCommandBuffer > m_transferCommandPool;
     ve::TransferCommandBuffer m_transferCommandBuffer;
     ve::MeshBuffers m_meshBuffers{};
@@ -90,9 +96,12 @@ private:
     ve::gltf::MetalicRoughness::Resources m_defaultResources;
     std::optional< ve::UniformBuffer > m_constantsBuffer;
     ve::RenderContext m_mainRenderContext;
+    std::vector< ve::VisibleObject > m_sortScratch;
     SceneData m_sceneData{};
     Scene m_scene;
     std::shared_ptr< ve::Camera > m_camera{};
+    float m_statsTime{}; // ms since the last frame statistics log
+    ve::GraphicsCommandBuffer::StateStats m_drawStateStats{}; // of the last recorded frame
 
     std::optional< ve::Pipeline > m_skyboxPipeline;
     std::optional< ve::PipelineLayout > m_skyboxPipelineLayout;
@@ -123,7 +132,8 @@ private:
     void draw( const uint32_t imageIndex );
     void present( const uint32_t imageIndex );
 
-    void drawScene( const ve::GraphicsCommandBuffer currentCommandBuffer, const vk::DescriptorSet currentGlobalSet );
+    void drawScene( const ve::GraphicsCommandBuffer currentCommandBuffer, const vk::DescriptorSet currentGlobalSet,
+                    std::span< const ve::VisibleObject > surfaces );
     void drawSkybox( const ve::GraphicsCommandBuffer currentCommandBuffer, const vk::DescriptorSet currentGlobalSet );
 
     void handleWindowResising();
@@ -0,0 +1,91 @@
+#include "Frustum.hpp"
+
+#include <glm/geometric.hpp>
+
+#if defined( __SSE__ ) || defined( _M_X64 )
+#include <xmmintrin.h>
+#define VE_SSE_CULLING
+#endif
+
+namespace {
+
+#ifdef VE_SSE_CULLING
+constexpr size_t g_batchSize{ 4U };
+#endif
+
+bool isSphereVisible( const ve::Frustum& frustum, const glm::vec4& sphere ) noexcept {
+    for ( const auto& plane : frustum.planes )
+        if ( glm::dot( glm::vec3{ plane }, glm::vec3{ sphere } ) + plane.w < -sphere.w )
+            return false;
+
+    return true;
+}
+
+} // namespace
+
+namespace ve {
+
+Frustum::Frustum( const glm::mat4& clipMatrix ) noexcept {
+    // Gribb-Hartmann: each plane is a sum or difference of the last row and one of the others
+    const auto row{ [ &clipMatrix ]( const glm::length_t index ) {
+        return glm::vec4{ clipMatrix[ 0 ][ index ], clipMatrix[ 1 ][ index ], clipMatrix[ 2 ][ index ],
+                          clipMatrix[ 3 ][ index ] };
+    } };
+
+#ifdef GLM_FORCE_DEPTH_ZERO_TO_ONE
+    const glm::vec4 nearPlane{ row( 2 ) };
+#else
+    const glm::vec4 nearPlane{ row( 3 ) + row( 2 ) };
+#endif
+
+    planes = { row( 3 ) + row( 0 ), row( 3 ) - row( 0 ), row( 3 ) + row( 1 ), row( 3 ) - row( 1 ), nearPlane,
+               row( 3 ) - row( 2 ) };
+    for ( auto& plane : planes ) {
+        const float length{ glm::length( glm::vec3{ plane } ) };
+        if ( length > 0.0F )
+            plane /= length;
+    }
+}
+
+size_t cullSpheres( const ve::Frustum& frustum, std::span< const glm::vec4 > spheres,
+                    std::span< uint8_t > visibility ) noexcept {
+    size_t visibleCount{};
+    size_t index{};
+
+#ifdef VE_SSE_CULLING
+    // four spheres are transposed into x, y, z and radius lanes, then every plane is tested against all of them
+    for ( ; index + g_batchSize <= std::size( spheres ); index += g_batchSize ) {
+        __m128 x{ _mm_loadu_ps( &spheres[ index ].x ) };
+        __m128 y{ _mm_loadu_ps( &spheres[ index + 1U ].x ) };
+        __m128 z{ _mm_loadu_ps( &spheres[ index + 2U ].x ) };
+        __m128 radius{ _mm_loadu_ps( &spheres[ index + 3U ].x ) };
+        _MM_TRANSPOSE4_PS( x, y, z, radius );
+
+        const __m128 negativeRadius{ _mm_sub_ps( _mm_setzero_ps(), radius ) };
+        __m128 inside{ _mm_cmpeq_ps( radius, radius ) };
+        for ( const auto& plane : frustum.planes ) {
+            const __m128 distance{ _mm_add_ps(
+                _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( plane.x ) ), _mm_mul_ps( y, _mm_set1_ps( plane.y ) ) ),
+                _mm_add_ps( _mm_mul_ps( z, _mm_set1_ps( plane.z ) ), _mm_set1_ps( plane.w ) ) ) };
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( distance, negativeRadius ) );
+        }
+
+        const int mask{ _mm_movemask_ps( inside ) };
+        for ( size_t lane{ 0U }; lane < g_batchSize; lane++ ) {
+            const bool isVisible{ ( mask & ( 1 << lane ) ) != 0 };
+            visibility[ index + lane ] = isVisible ? 1U : 0U;
+            visibleCount += isVisible ? 1U : 0U;
+        }
+    }
+#endif
+
+    for ( ; index < std::size( spheres ); index++ ) {
+        const bool isVisible{ isSphereVisible( frustum, spheres[ index ] ) };
+        visibility[ index ] = isVisible ? 1U : 0U;
+        visibleCount += isVisible ? 1U : 0U;
+    }
+
+    return visibleCount;
+}
+
+} // namespace ve
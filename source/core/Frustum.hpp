@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace ve {
+
+// View volume as six planes ( normal, distance ), a point is inside when dot( normal, point ) + distance >= 0 for
+// all of them. The default frustum has null planes and keeps everything.
+struct Frustum {
+    Frustum() = default;
+    // planes in the space the matrix maps to clip space from
+    explicit Frustum( const glm::mat4& clipMatrix ) noexcept;
+
+    std::array< glm::vec4, 6U > planes{};
+};
+
+// Tests spheres ( center, radius ) four at a time, writing 1 for the ones touching the frustum and 0 otherwise.
+// Returns the number of visible spheres, visibility has to be at least as long as spheres.
+size_t cullSpheres( const ve::Frustum& frustum, std::span< const glm::vec4 > spheres,
+                    std::span< uint8_t > visibility ) noexcept;
+
+} // namespace ve
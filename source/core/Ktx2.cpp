@@ -0,0 +1,118 @@
+#include "Ktx2.hpp"
+#include "TextureProcessing.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr std::array< uint8_t, 12U > g_identifier{ 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                                   0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct Header {
+    std::array< uint8_t, 12U > identifier;
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+static_assert( sizeof( Header ) == 80U );
+static_assert( sizeof( LevelIndex ) == 24U );
+
+} // namespace
+
+namespace ve::ktx2 {
+
+bool isKtx2( std::span< const std::byte > bytes ) noexcept {
+    return std::size( bytes ) >= std::size( g_identifier ) &&
+           memcmp( std::data( bytes ), std::data( g_identifier ), std::size( g_identifier ) ) == 0;
+}
+
+std::optional< Texture > read( std::span< const std::byte > bytes ) {
+    if ( !isKtx2( bytes ) || std::size( bytes ) < sizeof( Header ) ) {
+        spdlog::warn( "KTX2: invalid file header" );
+        return std::nullopt;
+    }
+
+    Header header;
+    memcpy( &header, std::data( bytes ), sizeof( Header ) );
+
+    const auto format{ static_cast< vk::Format >( header.vkFormat ) };
+    if ( format == vk::Format::eUndefined ) {
+        spdlog::warn( "KTX2: Basis Universal textures need transcoding, which is not supported" );
+        return std::nullopt;
+    }
+
+    if ( header.supercompressionScheme != 0U ) {
+        spdlog::warn( "KTX2: supercompression scheme {} is not supported", header.supercompressionScheme );
+        return std::nullopt;
+    }
+
+    const bool isTexture2D{ header.pixelWidth != 0U && header.pixelHeight != 0U && header.pixelDepth <= 1U &&
+                            header.layerCount <= 1U && header.faceCount == 1U };
+    if ( !isTexture2D ) {
+        spdlog::warn( "KTX2: only 2D textures are supported" );
+        return std::nullopt;
+    }
+
+    if ( format != vk::Format::eR8G8B8A8Unorm && format != vk::Format::eR8G8B8A8Srgb &&
+         !ve::texture::isBlockCompressed( format ) ) {
+        spdlog::warn( "KTX2: format {} is not supported", vk::to_string( format ) );
+        return std::nullopt;
+    }
+
+    Texture texture{};
+    texture.format    = format;
+    texture.extent    = vk::Extent2D{ header.pixelWidth, header.pixelHeight };
+    texture.mipLevels = std::min( std::max( header.levelCount, 1U ), ve::texture::getMipLevelsCount( texture.extent ) );
+
+    const uint64_t levelIndexSize{ std::max( header.levelCount, 1U ) * uint64_t{ sizeof( LevelIndex ) } };
+    if ( std::size( bytes ) - sizeof( Header ) < levelIndexSize ) {
+        spdlog::warn( "KTX2: level index is truncated" );
+        return std::nullopt;
+    }
+
+    texture.texels.resize( ve::texture::getMipChainSize( format, texture.extent, texture.mipLevels ) );
+    size_t texelsOffset{};
+    for ( uint32_t mipLevel{ 0U }; mipLevel < texture.mipLevels; mipLevel++ ) {
+        LevelIndex level;
+        memcpy( &level, std::data( bytes ) + sizeof( Header ) + mipLevel * sizeof( LevelIndex ), sizeof( LevelIndex ) );
+
+        const auto levelExtent{ ve::texture::getMipExtent( texture.extent, mipLevel ) };
+        const auto levelSize{ ve::texture::getLevelSize( format, levelExtent ) };
+        const bool isLevelValid{ level.byteLength == levelSize && level.byteOffset <= std::size( bytes ) &&
+                                 level.byteLength <= std::size( bytes ) - level.byteOffset };
+        if ( !isLevelValid ) {
+            spdlog::warn( "KTX2: mip level {} is out of bounds or has an unexpected size", mipLevel );
+            return std::nullopt;
+        }
+
+        memcpy( std::data( texture.texels ) + texelsOffset, std::data( bytes ) + level.byteOffset, levelSize );
+        texelsOffset += levelSize;
+    }
+
+    return texture;
+}
+
+} // namespace ve::ktx2
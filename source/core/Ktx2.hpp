@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ve::ktx2 {
+
+struct Texture {
+    vk::Format format{ vk::Format::eUndefined };
+    vk::Extent2D extent{};
+    uint32_t mipLevels{ 1U };
+    std::vector< std::byte > texels; // levels tightly packed, starting with the base level
+};
+
+bool isKtx2( std::span< const std::byte > bytes ) noexcept;
+
+// Reads a 2D KTX2 texture whose levels can be uploaded as they are. Basis Universal payloads and
+// supercompressed levels would need transcoding, so they are rejected like malformed files.
+std::optional< Texture > read( std::span< const std::byte > bytes );
+
+} // namespace ve::ktx2
@@ -1,5 +1,11 @@
 #include "Loader.hpp"
 #include "Engine.hpp"
+#include "Config.hpp"
+#include "Constants.hpp"
+#include "TextureProcessing.hpp"
+#include "MeshProcessing.hpp"
+#include "MappedFile.hpp"
+#include "Ktx2.hpp"
 
 #include <fastgltf/util.hpp>
 #include <fastgltf/tools.hpp>
@@ -7,142 +13,836 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <stb_image.h>
 
 #include <spdlog/spdlog.h>
 
 #include <variant>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <tuple>
+
+namespace {
+
+constexpr float g_mebibyte{ 1024.0F * 1024.0F };
+
+std::span< const std::byte > getBufferBytes( const fastgltf::Buffer& buffer ) {
+    std::span< const std::byte > bytes{};
+    const auto ignoreRestDataSource{ []( auto& ) {} };
+
+    const auto handleVector{ [ &bytes ]( const fastgltf::sources::Vector& vector ) {
+        bytes = std::span{ std::data( vector.bytes ), std::size( vector.bytes ) };
+    } };
+
+    const auto handleArray{ [ &bytes ]( const fastgltf::sources::Array& array ) {
+        bytes = std::span{ std::data( array.bytes ), std::size( array.bytes ) };
+    } };
+
+    const auto handleByteView{ [ &bytes ]( const fastgltf::sources::ByteView& byteView ) {
+        bytes = std::span{ std::data( byteView.bytes ), std::size( byteView.bytes ) };
+    } };
+
+    std::visit( fastgltf::visitor{ handleVector, handleArray, handleByteView, ignoreRestDataSource }, buffer.data );
+
+    return bytes;
+}
+
+// accessor data source which serves EXT_meshopt_compression views from their decoded copies
+struct BufferViewAdapter {
+    std::span< const std::vector< std::byte > > decodedViews;
+
+    fastgltf::span< const std::byte > operator()( const fastgltf::Asset& asset, const size_t bufferViewIndex ) const {
+        if ( bufferViewIndex < std::size( decodedViews ) && !decodedViews[ bufferViewIndex ].empty() ) {
+            const auto& decodedView{ decodedViews[ bufferViewIndex ] };
+            return { std::data( decodedView ), std::size( decodedView ) };
+        }
+
+        return fastgltf::DefaultBufferDataAdapter{}( asset, bufferViewIndex );
+    }
+};
+
+template < typename T >
+bool copyAttribute( const fastgltf::Asset& asset, const fastgltf::Primitive& primitive,
+                    const std::string_view attributeName, const size_t verticesCount, std::vector< T >& stream,
+                    const BufferViewAdapter& adapter ) {
+    const auto attribute{ primitive.findAttribute( attributeName ) };
+    if ( attribute == std::end( primitive.attributes ) )
+        return false;
+
+    const auto& accessor{ asset.accessors.at( attribute->accessorIndex ) };
+    if ( accessor.type != fastgltf::ElementTraits< T >::type || accessor.count < verticesCount )
+        return false;
+
+    // quantized accessors are converted by fastgltf, normalized integers to [0, 1] or [-1, 1]
+    stream.resize( accessor.count );
+    fastgltf::copyFromAccessor< T >( asset, accessor, std::data( stream ), adapter );
+    return true;
+}
+
+glm::vec2 octEncode( const glm::vec3 direction ) noexcept {
+    const float length{ std::abs( direction.x ) + std::abs( direction.y ) + std::abs( direction.z ) };
+    if ( length == 0.0F )
+        return glm::vec2{ 0.0F };
+
+    const glm::vec3 octahedron{ direction / length };
+    const glm::vec2 projection{ octahedron.x, octahedron.y };
+    if ( octahedron.z >= 0.0F )
+        return projection;
+
+    // the lower hemisphere is folded over the diagonals of the square
+    const glm::vec2 signs{ projection.x >= 0.0F ? 1.0F : -1.0F, projection.y >= 0.0F ? 1.0F : -1.0F };
+    return ( 1.0F - glm::abs( glm::vec2{ projection.y, projection.x } ) ) * signs;
+}
+
+ve::PackedVertex packVertex( const ve::Vertex& vertex, const glm::vec3 positionOffset,
+                             const glm::vec3 positionScale ) noexcept {
+    const glm::vec3 position{ glm::clamp( ( vertex.position - positionOffset ) / positionScale, 0.0F, 1.0F ) };
+    const float tangentSign{ vertex.tangent.w < 0.0F ? 0.0F : 1.0F };
+
+    ve::PackedVertex packedVertex;
+    packedVertex.positionXY = glm::packUnorm2x16( glm::vec2{ position.x, position.y } );
+    packedVertex.positionZ  = glm::packUnorm2x16( glm::vec2{ position.z, tangentSign } );
+    packedVertex.normal     = glm::packSnorm2x16( octEncode( vertex.normal ) );
+    packedVertex.tangent    = glm::packSnorm2x16( octEncode( glm::vec3{ vertex.tangent } ) );
+    packedVertex.uv         = glm::packHalf2x16( glm::vec2{ vertex.uv_x, vertex.uv_y } );
+    return packedVertex;
+}
+
+} // namespace
 
 namespace ve::gltf {
 
 Loader::Loader( ve::Engine& engine, const ve::MemoryAllocator& allocator )
-    : m_engine{ engine }, m_memoryAllocator{ allocator } {}
+    : m_engine{ engine }, m_memoryAllocator{ allocator }, m_uploadBatch{ engine.createUploadBatch() } {
+    m_isBlockCompressionEnabled = cfg::texture::blockCompression && supportsBlockCompression();
+    if ( cfg::texture::blockCompression && !m_isBlockCompressionEnabled )
+        spdlog::warn( "BC texture formats are not supported, textures are uploaded uncompressed" );
+}
 
-std::optional< std::shared_ptr< ve::gltf::Scene > > Loader::load( const std::filesystem::path& path ) {
+std::shared_ptr< ve::gltf::Scene > Loader::load( const std::filesystem::path& path ) {
     spdlog::info( "Loading model: {}", path.string() );
-    const auto asset{ getAsset( path ) };
-    if ( !asset.has_value() )
+
+    PendingScene& pending{ m_pendingScenes.emplace_back() };
+    pending.scene        = std::make_shared< ve::gltf::Scene >();
+    pending.scene->path  = path;
+    pending.loadingStart = std::chrono::high_resolution_clock::now();
+    pending.cooking      = std::async( std::launch::async, [ this, path ]() { return prepare( path ); } );
+
+    auto scene{ pending.scene };
+    if constexpr ( !cfg::loader::streaming ) {
+        pending.cooking.wait();
+        bool isFinished{ false };
+        while ( !isFinished && !pending.isLoaded )
+            isFinished = stream( pending );
+
+        if ( isFinished )
+            m_pendingScenes.pop_back();
+    }
+
+    return scene;
+}
+
+void Loader::update() {
+    m_frameIndex++;
+    std::erase_if( m_pendingScenes, [ this ]( PendingScene& pending ) { return stream( pending ); } );
+}
+
+std::optional< CookedScene > Loader::prepare( const std::filesystem::path& path ) {
+    // cooking uses the import scratch state of the loader, so scenes are cooked one at a time
+    const std::scoped_lock lock{ m_cookingMutex };
+
+    using namespace std::chrono;
+    const auto preparingStart{ high_resolution_clock::now() };
+
+    const auto cachePath{ cache::getCachePath( path ) };
+    std::optional< CookedScene > cooked{};
+    if constexpr ( cfg::loader::sceneCache )
+        cooked = cache::read( cachePath, path, getCacheOptions() );
+
+    // a cache written on another device may hold formats this one cannot sample, it is cooked again then
+    if ( cooked.has_value() && !std::ranges::all_of( cooked->images, [ this ]( const CookedImage& image ) {
+             return supportsFormat( image.format );
+         } ) ) {
+        spdlog::info( "Scene cache has texture formats the device does not support: {}", cachePath.string() );
+        cooked.reset();
+    }
+
+    const bool isCached{ cooked.has_value() };
+    if ( !isCached ) {
+        cooked = cook( path );
+        if ( !cooked.has_value() )
+            return std::nullopt;
+
+        if constexpr ( cfg::loader::sceneCache )
+            cache::write( cachePath, path, getCacheOptions(), cooked.value() );
+    }
+
+    const duration< float, std::milli > preparingTime{ high_resolution_clock::now() - preparingStart };
+    spdlog::info( "Prepared {} in {:.1f} ms ({})", path.filename().string(), preparingTime.count(),
+                  isCached ? "scene cache" : "glTF import" );
+
+    return cooked;
+}
+
+std::optional< CookedScene > Loader::cook( const std::filesystem::path& path ) {
+    const auto mappedAsset{ getAsset( path ) };
+    if ( !mappedAsset.has_value() )
         return std::nullopt;
 
+    const fastgltf::Asset& asset{ mappedAsset->asset };
+    if ( !decodeBufferViews( asset ) )
+        return std::nullopt;
+
+    CookedScene cooked;
+    cooked.samplers.reserve( std::size( asset.samplers ) );
+    std::ranges::for_each( asset.samplers, [ &cooked ]( const fastgltf::Sampler& sampler ) {
+        auto& cookedSampler{ cooked.samplers.emplace_back() };
+        if ( sampler.magFilter.has_value() )
+            cookedSampler.magFilter = sampler.magFilter.value();
+        if ( sampler.minFilter.has_value() )
+            cookedSampler.minFilter = sampler.minFilter.value();
+    } );
+
+    m_decodedImages = decodeImages( asset, path.parent_path() );
+    cookMaterials( asset, cooked );
+    cookMeshes( asset, cooked );
+    cookNodes( asset, cooked );
+    if constexpr ( cfg::geometry::packedVertices )
+        packVertices( cooked );
+    if constexpr ( cfg::geometry::shortIndices )
+        narrowIndices( cooked );
+
+    m_decodedImages.clear();
+    m_decodedViews.clear();
+    m_imageAliases.clear();
+    m_imageCache.clear();
+
+    cookTextures( cooked );
+    m_imageUsages.clear();
+
+    return cooked;
+}
+
+std::vector< Loader::DecodedImage > Loader::decodeImages( const fastgltf::Asset& asset,
+                                                         const std::filesystem::path& directory ) {
+    using namespace std::chrono;
+    const auto decodingStart{ high_resolution_clock::now() };
+
+    std::unordered_map< std::string, size_t > sourceKeys;
+    m_imageAliases.clear();
+    m_imageAliases.reserve( std::size( asset.images ) );
+
+    std::vector< std::optional< std::future< DecodedImage > > > pendingImages( std::size( asset.images ) );
+    for ( size_t imageIndex{ 0U }; imageIndex < std::size( asset.images ); imageIndex++ ) {
+        const fastgltf::Image& image{ asset.images.at( imageIndex ) };
+        const auto [ sourceIt, isUnique ]{ sourceKeys.try_emplace( getImageSourceKey( asset, image, directory ),
+                                                                   imageIndex ) };
+        m_imageAliases.emplace_back( sourceIt->second );
+
+        if ( isUnique )
+            pendingImages.at( imageIndex ) = m_threadPool.submit(
+                [ &asset, &image, &directory ]() { return decodeImage( asset, image, directory ); } );
+    }
+
+    std::vector< DecodedImage > decodedImages( std::size( pendingImages ) );
+    for ( size_t imageIndex{ 0U }; imageIndex < std::size( pendingImages ); imageIndex++ ) {
+        auto& pendingImage{ pendingImages.at( imageIndex ) };
+        decodedImages.at( imageIndex ) = pendingImage.has_value() ? pendingImage->get()
+                                                                  : decodedImages.at( m_imageAliases.at( imageIndex ) );
+    }
+
+    const duration< float, std::milli > decodingTime{ high_resolution_clock::now() - decodingStart };
+    spdlog::info( "Decoded {} unique of {} images on {} threads in {:.1f} ms", std::size( sourceKeys ),
+                  std::size( decodedImages ), m_threadPool.size(), decodingTime.count() );
+
+    return decodedImages;
+}
+
+std::span< const std::byte > Loader::getImageBytes( const fastgltf::Asset& asset, const fastgltf::Image& image ) {
+    std::span< const std::byte > bytes{};
+    const auto ignoreRestDataSource{ []( auto& ) {} };
+
+    const auto handleVector{ [ &bytes ]( const fastgltf::sources::Vector& vector ) {
+        bytes = std::span{ std::data( vector.bytes ), std::size( vector.bytes ) };
+    } };
+
+    const auto handleBufferView{ [ &asset, &bytes ]( const fastgltf::sources::BufferView& view ) {
+        auto& bufferView{ asset.bufferViews.at( view.bufferViewIndex ) };
+        const auto bufferBytes{ getBufferBytes( asset.buffers.at( bufferView.bufferIndex ) ) };
+        if ( bufferView.byteOffset + bufferView.byteLength <= std::size( bufferBytes ) )
+            bytes = bufferBytes.subspan( bufferView.byteOffset, bufferView.byteLength );
+    } };
+
+    const auto handleByteView{ [ &bytes ]( const fastgltf::sources::ByteView& byteView ) {
+        bytes = std::span{ std::data( byteView.bytes ), std::size( byteView.bytes ) };
+    } };
+
+    std::visit( fastgltf::visitor{ handleVector, handleByteView, handleBufferView, ignoreRestDataSource },
+                image.data );
+
+    return bytes;
+}
+
+std::string Loader::getImageSourceKey( const fastgltf::Asset& asset, const fastgltf::Image& image,
+                                       const std::filesystem::path& directory ) {
+    if ( const auto *filePath{ std::get_if< fastgltf::sources::URI >( &image.data ) } )
+        return ( directory / filePath->uri.fspath() ).lexically_normal().string();
+
+    const auto bytes{ getImageBytes( asset, image ) };
+    const std::string_view content{ reinterpret_cast< const char * >( std::data( bytes ) ), std::size( bytes ) };
+
+    return std::format( "{}:{:016x}", std::size( content ), std::hash< std::string_view >{}( content ) );
+}
+
+Loader::DecodedImage Loader::decodeImage( const fastgltf::Asset& asset, const fastgltf::Image& image,
+                                          const std::filesystem::path& directory ) {
+    if ( const auto *filePath{ std::get_if< fastgltf::sources::URI >( &image.data ) } ) {
+        assert( filePath->fileByteOffset == 0 );
+        assert( filePath->uri.isLocalPath() );
+
+        try {
+            const ve::MappedFile file{ directory / filePath->uri.fspath() };
+            return decodeImage( file.get() );
+        } catch ( const std::runtime_error& error ) {
+            spdlog::error( "failed to load texture: {}", error.what() );
+            return {};
+        }
+    }
+
+    return decodeImage( getImageBytes( asset, image ) );
+}
+
+Loader::DecodedImage Loader::decodeImage( std::span< const std::byte > bytes ) {
+    DecodedImage decodedImage{};
+
+    if ( ve::ktx2::isKtx2( bytes ) ) {
+        auto texture{ ve::ktx2::read( bytes ) };
+        if ( !texture.has_value() )
+            return decodedImage;
+
+        auto texels{ std::make_shared< const std::vector< std::byte > >( std::move( texture->texels ) ) };
+        decodedImage.texels    = *texels;
+        decodedImage.storage   = std::move( texels );
+        decodedImage.extent    = texture->extent;
+        decodedImage.format    = texture->format;
+        decodedImage.mipLevels = texture->mipLevels;
+        return decodedImage;
+    }
+
+    int width{};
+    int height{};
+    int nrChannels;
+    stbi_uc *data{ nullptr };
+    if ( !bytes.empty() )
+        data = stbi_load_from_memory( reinterpret_cast< const stbi_uc * >( std::data( bytes ) ),
+                                      static_cast< int >( std::size( bytes ) ), &width, &height, &nrChannels,
+                                      STBI_rgb_alpha );
+
+    if ( data == nullptr ) {
+        spdlog::error( "failed to load texture" );
+        return decodedImage;
+    }
+
+    decodedImage.extent  = vk::Extent2D{ static_cast< uint32_t >( width ), static_cast< uint32_t >( height ) };
+    decodedImage.texels  = std::span{ reinterpret_cast< const std::byte * >( data ),
+                                     ve::texture::getLevelSize( vk::Format::eR8G8B8A8Unorm, decodedImage.extent ) };
+    decodedImage.storage = std::shared_ptr< stbi_uc >( data, stbi_image_free );
+
+    return decodedImage;
+}
+
+int32_t Loader::cookImage( CookedScene& cooked, const size_t imageIndex, const ve::texture::Usage usage ) {
+    const ImageKey key{ m_imageAliases.at( imageIndex ), usage };
+    if ( const auto cachedImage{ m_imageCache.find( key ) }; cachedImage != std::end( m_imageCache ) )
+        return cachedImage->second;
+
+    const auto& decodedImage{ m_decodedImages.at( imageIndex ) };
+    if ( decodedImage.texels.empty() )
+        return -1;
+
+    const bool isPrebuilt{ decodedImage.format != vk::Format::eUndefined };
+    if ( isPrebuilt && !supportsFormat( decodedImage.format ) ) {
+        spdlog::warn( "Texture format {} is not supported by the device", vk::to_string( decodedImage.format ) );
+        return -1;
+    }
+
+    CookedImage& image{ cooked.images.emplace_back() };
+    image.format    = isPrebuilt ? decodedImage.format : ve::texture::getUncompressedFormat( usage );
+    image.extent    = decodedImage.extent;
+    image.mipLevels = decodedImage.mipLevels;
+    image.texels    = decodedImage.texels;
+    image.storage   = decodedImage.storage;
+    m_imageUsages.emplace_back( usage );
+
+    const auto cookedIndex{ static_cast< int32_t >( std::size( cooked.images ) - 1U ) };
+    m_imageCache.emplace( key, cookedIndex );
+
+    return cookedIndex;
+}
+
+void Loader::cookTextures( CookedScene& cooked ) {
+    // block compressed images cannot be blitted and streamed ones upload any part of their chain, so their mips are
+    // built on the CPU
+    if ( !cfg::loader::sceneCache && !m_isBlockCompressionEnabled && !cfg::texture::mipStreaming )
+        return;
+
+    using namespace std::chrono;
+    const auto cookingStart{ high_resolution_clock::now() };
+
+    std::vector< std::future< void > > pendingImages;
+    pendingImages.reserve( std::size( cooked.images ) );
+    for ( size_t imageIndex{ 0U }; imageIndex < std::size( cooked.images ); imageIndex++ ) {
+        auto& image{ cooked.images.at( imageIndex ) };
+        const auto usage{ m_imageUsages.at( imageIndex ) };
+
+        // images from KTX2 files are uploaded as shipped
+        if ( image.format != ve::texture::getUncompressedFormat( usage ) || image.mipLevels > 1U )
+            continue;
+
+        pendingImages.emplace_back( m_threadPool.submit( [ &image, usage, this ]() {
+            const bool isSrgb{ image.format == vk::Format::eR8G8B8A8Srgb };
+            const uint32_t mipLevels{ ve::texture::getMipLevelsCount( image.extent ) };
+            auto mipChain{ std::make_shared< std::vector< std::byte > >(
+                ve::texture::generateMipChain( image.texels, image.extent, isSrgb ) ) };
+
+            if ( m_isBlockCompressionEnabled ) {
+                const auto blockFormat{ ve::texture::getBlockFormat(
+                    usage, ve::texture::hasTranslucentTexels( image.texels ) ) };
+
+                *mipChain    = ve::texture::compressMipChain( *mipChain, image.extent, mipLevels, blockFormat );
+                image.format = blockFormat;
+            }
+
+            image.mipLevels = mipLevels;
+            image.texels    = *mipChain;
+            image.storage   = std::move( mipChain );
+        } ) );
+    }
+    std::ranges::for_each( pendingImages, []( auto& pendingImage ) { pendingImage.get(); } );
+
+    vk::DeviceSize uncompressedSize{};
+    vk::DeviceSize cookedSize{};
+    std::ranges::for_each( cooked.images, [ &uncompressedSize, &cookedSize ]( const CookedImage& image ) {
+        uncompressedSize += ve::texture::getMipChainSize( vk::Format::eR8G8B8A8Unorm, image.extent, image.mipLevels );
+        cookedSize += std::size( image.texels );
+    } );
+
+    const duration< float, std::milli > cookingTime{ high_resolution_clock::now() - cookingStart };
+    spdlog::info( "Cooked {} textures ({}) in {:.1f} ms: {:.1f} MiB -> {:.1f} MiB", std::size( cooked.images ),
+                  m_isBlockCompressionEnabled ? "BC1/BC3/BC5" : "RGBA8", cookingTime.count(),
+                  static_cast< float >( uncompressedSize ) / g_mebibyte,
+                  static_cast< float >( cookedSize ) / g_mebibyte );
+}
+
+bool Loader::supportsBlockCompression() const {
+    if ( !m_engine.getLogicalDevice().isBlockCompressionEnabled() )
+        return false;
+
+    static constexpr std::array blockFormats{ vk::Format::eBc1RgbSrgbBlock, vk::Format::eBc1RgbUnormBlock,
+                                              vk::Format::eBc3SrgbBlock, vk::Format::eBc3UnormBlock,
+                                              vk::Format::eBc5UnormBlock };
+    return std::ranges::all_of( blockFormats,
+                                [ this ]( const vk::Format format ) { return supportsFormat( format ); } );
+}
+
+bool Loader::supportsFormat( const vk::Format format ) const {
+    static constexpr vk::FormatFeatureFlags requiredFeatures{ vk::FormatFeatureFlagBits::eSampledImage |
+                                                              vk::FormatFeatureFlagBits::eSampledImageFilterLinear |
+                                                              vk::FormatFeatureFlagBits::eTransferDst };
+
+    const auto& logicalDevice{ m_engine.getLogicalDevice() };
+    if ( ve::texture::isBlockCompressed( format ) && !logicalDevice.isBlockCompressionEnabled() )
+        return false;
+
+    const auto properties{ logicalDevice.getParentPhysicalDevice().get().getFormatProperties( format ) };
+    return ( properties.optimalTilingFeatures & requiredFeatures ) == requiredFeatures;
+}
+
+uint32_t Loader::getMipLevelsCount( const CookedImage& image ) noexcept {
+    // a single uncompressed level gets the rest of its chain blitted, anything else is uploaded as provided
+    if ( image.mipLevels == 1U && !ve::texture::isBlockCompressed( image.format ) )
+        return ve::texture::getMipLevelsCount( image.extent );
+
+    return image.mipLevels;
+}
+
+uint32_t Loader::getCacheOptions() const noexcept {
+    uint32_t options{ m_isBlockCompressionEnabled ? cache::g_blockCompressionOption : 0U };
+    if constexpr ( cfg::geometry::packedVertices )
+        options |= cache::g_packedVerticesOption;
+    if constexpr ( cfg::geometry::optimizeIndices )
+        options |= cache::g_optimizedIndicesOption;
+    if constexpr ( cfg::geometry::shortIndices )
+        options |= cache::g_shortIndicesOption;
+    if constexpr ( cfg::geometry::lods )
+        options |= cache::g_lodsOption;
+
+    return options;
+}
+
+bool Loader::stream( PendingScene& pending ) {
+    if ( pending.isLoaded ) {
+        if ( m_uploadBatch.poll() )
+            updateResidency( pending );
+        return false;
+    }
+
+    using namespace std::chrono;
+    const auto& path{ pending.scene->path };
+
+    if ( !pending.cooked.has_value() ) {
+        if ( pending.cooking.wait_for( seconds{ 0 } ) != std::future_status::ready )
+            return false;
+
+        pending.cooked = pending.cooking.get();
+        if ( !pending.cooked.has_value() ) {
+            spdlog::error( "Failed to load {}", path.string() );
+            return true;
+        }
+
+        // geometry goes first, textures follow in budgeted steps on the next frames
+        instantiateGeometry( pending );
+        const duration< float, std::milli > visibleTime{ high_resolution_clock::now() - pending.loadingStart };
+        spdlog::info( "Geometry of {} visible after {:.1f} ms", path.filename().string(), visibleTime.count() );
+        return false;
+    }
+
+    if ( !m_uploadBatch.poll() )
+        return false;
+
+    streamImages( pending );
+    resolveMaterials( pending );
+    if ( pending.nextImage < std::size( pending.cooked->images ) )
+        return false;
+
+    computeImageCacheStats( pending.cooked.value(), *pending.scene );
+    const auto& cacheStats{ pending.scene->imageCacheStats };
+    spdlog::info( "Texture cache: {} unique images, {} reused, {:.1f} MiB of VRAM saved", cacheStats.uniqueImages,
+                  cacheStats.reusedImages, static_cast< float >( cacheStats.savedBytes ) / g_mebibyte );
+
+    spdlog::info( "Texture residency: {:.1f} MiB of {:.1f} MiB resident, {:.1f} MiB budget",
+                  static_cast< float >( getResidentSize( *pending.scene, false ) ) / g_mebibyte,
+                  static_cast< float >( getResidentSize( *pending.scene, true ) ) / g_mebibyte,
+                  static_cast< float >( cfg::texture::streamingBudget ) / g_mebibyte );
+
+    const duration< float, std::milli > loadingTime{ high_resolution_clock::now() - pending.loadingStart };
+    spdlog::info( "Loaded {} in {:.1f} ms", path.filename().string(), loadingTime.count() );
+
+    pending.isLoaded = true;
+    return !cfg::texture::mipStreaming;
+}
+
+void Loader::instantiateGeometry( PendingScene& pending ) {
     using Ratio = ve::DescriptorAllocator::PoolSizeRatio;
     constexpr std::array< Ratio, 3U > sizes{ Ratio{ vk::DescriptorType::eCombinedImageSampler, 3 },
                                              Ratio{ vk::DescriptorType::eUniformBuffer, 3 },
                                              Ratio{ vk::DescriptorType::eStorageBuffer, 1 } };
 
     const auto& logicalDevice{ m_engine.getLogicalDevice() };
-    const uint32_t setsCount{ ve::utils::size( asset->materials ) };
-
-    std::shared_ptr< ve::gltf::Scene > scene{ std::make_shared< ve::gltf::Scene >() };
-    scene->path = path;
+    const CookedScene& cooked{ pending.cooked.value() };
+    ve::gltf::Scene& scene{ *pending.scene };
+    const uint32_t setsCount{ ve::utils::size( cooked.materials ) };
 
     if ( setsCount != 0U )
-        scene->descriptorAllocator.emplace( logicalDevice, setsCount, sizes );
+        scene.descriptorAllocator.emplace( logicalDevice, setsCount, sizes );
 
-    scene->samplers.reserve( std::size( asset->samplers ) );
-    std::ranges::for_each( asset.value().samplers, [ &scene, &logicalDevice ]( const auto& gltfSampler ) {
-        scene->samplers.emplace_back( logicalDevice, gltfSampler );
+    scene.samplers.reserve( std::size( cooked.samplers ) );
+    std::ranges::for_each( cooked.samplers, [ &scene, &logicalDevice ]( const CookedSampler& sampler ) {
+        fastgltf::Sampler gltfSampler{};
+        if ( sampler.magFilter.has_value() )
+            gltfSampler.magFilter = sampler.magFilter.value();
+        if ( sampler.minFilter.has_value() )
+            gltfSampler.minFilter = sampler.minFilter.value();
+
+        scene.samplers.emplace_back( logicalDevice, gltfSampler );
     } );
 
-    setNodesRalationship( asset.value(), *scene );
+    scene.images.reserve( std::size( cooked.images ) );
+    pending.lastSeenFrames.assign( std::size( cooked.images ), 0U );
+    pending.materialSets.assign( std::size( cooked.materials ), nullptr );
+    pending.materialSurfaces.assign( std::size( cooked.materials ), {} );
+    pending.materialCoverage.assign( std::size( cooked.materials ), {} );
+
+    loadMaterialConstants( cooked, scene );
+    loadMeshes( pending );
+    loadNodes( cooked, scene );
+    scene.createRenderObjects();
+
+    // only the texels are needed from now on
+    CookedScene& uploaded{ pending.cooked.value() };
+    uploaded.vertices                 = {};
+    uploaded.packedVertices           = {};
+    uploaded.indices                  = {};
+    uploaded.shortIndices             = {};
+    uploaded.vertexStorage            = {};
+    uploaded.packedVertexStorage      = {};
+    uploaded.indexStorage             = {};
+    uploaded.shortIndexStorage        = {};
+    uploaded.instanceTransforms       = {};
+    uploaded.instanceTransformStorage = {};
+}
 
-    return scene;
+void Loader::streamImages( PendingScene& pending ) {
+    const auto& images{ pending.cooked->images };
+    if ( pending.nextImage >= std::size( images ) )
+        return;
+
+    using namespace std::chrono;
+    const auto uploadStart{ high_resolution_clock::now() };
+
+    // at least one image per step, so a texture larger than the budget still makes progress
+    static constexpr uint64_t budget{ cfg::loader::streaming ? cfg::loader::streamingBytesPerFrame
+                                                             : std::numeric_limits< uint64_t >::max() };
+    const size_t firstImage{ pending.nextImage };
+    uint64_t uploadedBytes{};
+    do {
+        auto& texture{ pending.scene->images.emplace_back( images.at( pending.nextImage++ ) ) };
+        loadImage( m_uploadBatch, texture, cfg::texture::mipStreaming ? texture.getTailLevel() : 0U );
+        uploadedBytes += texture.getResidentSize();
+    } while ( pending.nextImage < std::size( images ) && uploadedBytes < budget );
+
+    m_uploadBatch.submit();
+
+    const duration< float, std::milli > uploadTime{ high_resolution_clock::now() - uploadStart };
+    spdlog::debug( "Streamed textures {}-{} of {} ({:.1f} MiB) in {:.1f} ms", firstImage, pending.nextImage - 1U,
+                   std::size( images ), static_cast< float >( uploadedBytes ) / g_mebibyte,
+                   uploadTime.count() );
 }
 
-std::optional< ve::Image > Loader::loadImage( const fastgltf::Asset& asset, ve::gltf::Scene& scene,
-                                              const fastgltf::Image& image, const vk::Format textureFormat ) {
-    std::optional< ve::Image > newImage{};
-    int width;
-    int height;
-    int nrChannels;
+void Loader::resolveMaterials( PendingScene& pending ) {
+    const CookedScene& cooked{ pending.cooked.value() };
+    ve::gltf::Scene& scene{ *pending.scene };
 
-    const auto createTextureImage{ [ &width, &height, &newImage, textureFormat, this ]( stbi_uc *data ) {
-        if ( data ) {
-            vk::Extent2D imagesize{ static_cast< uint32_t >( width ), static_cast< uint32_t >( height ) };
-            const uint32_t mipLevels{ static_cast< uint32_t >( std::floor( std::log2( std::max( width, height ) ) ) ) +
-                                      1U };
-            newImage.emplace( m_engine.createImage( data, imagesize, textureFormat,
-                                                    vk::ImageUsageFlagBits::eTransferSrc |
-                                                        vk::ImageUsageFlagBits::eTransferDst |
-                                                        vk::ImageUsageFlagBits::eSampled,
-                                                    mipLevels ) );
-            stbi_image_free( data );
-        } else {
-            spdlog::error( "failed to load texture" );
-        }
+    const auto isResident{ [ &scene ]( const CookedTexture& texture ) {
+        return texture.imageIndex < 0 || static_cast< size_t >( texture.imageIndex ) < std::size( scene.images );
     } };
 
-    const auto ignoreRestDataSource{ []( auto& ) {} };
+    // surfaces switch from the default material once all textures of their own material are resident
+    for ( size_t index{ 0U }; index < std::size( cooked.materials ); index++ ) {
+        const CookedMaterial& material{ cooked.materials.at( index ) };
+        if ( !pending.materialSets.at( index ) && isResident( material.baseColor ) && isResident( material.normal ) &&
+             isResident( material.metalicRoughness ) )
+            writeSceneMaterial( pending, index );
+    }
+}
 
-    const auto handleURI{ [ & ]( const fastgltf::sources::URI& filePath ) {
-        assert( filePath.fileByteOffset == 0 );
-        assert( filePath.uri.isLocalPath() );
+void Loader::writeSceneMaterial( PendingScene& pending, const size_t index ) {
+    const CookedMaterial& material{ pending.cooked->materials.at( index ) };
+    ve::gltf::Scene& scene{ *pending.scene };
+    auto& materialBuilder{ m_engine.getMaterialBuiler() };
+
+    // the previous set may still be bound by frames in flight, so it is retired and a free one is written instead
+    vk::DescriptorSet& materialSet{ pending.materialSets.at( index ) };
+    if ( materialSet )
+        pending.retiredSets.emplace_back( m_frameIndex, materialSet );
+
+    if ( pending.freeSets.empty() ) {
+        materialSet = scene.descriptorAllocator->allocate( materialBuilder.desMaterialLayout.value() );
+    } else {
+        materialSet = pending.freeSets.back();
+        pending.freeSets.pop_back();
+    }
 
-        const auto uriRelativePath{ filePath.uri.fspath() };
-        const auto path( scene.path.parent_path() / uriRelativePath );
+    scene.materials.erase( material.name );
+    const auto& materialPair{ scene.materials.emplace(
+        material.name,
+        materialBuilder.writeMaterial( material.type, loadResources( index, scene, material ), materialSet ) ) };
 
-        stbi_uc *data{ stbi_load( path.string().c_str(), &width, &height, &nrChannels, STBI_rgb_alpha ) };
-        createTextureImage( data );
-    } };
+    std::ranges::for_each( pending.materialSurfaces.at( index ), [ &materialPair ]( const SurfaceRef& surface ) {
+        surface.first->surfaces.at( surface.second ).material.emplace( materialPair.first->second );
+    } );
+}
+
+void Loader::updateResidency( PendingScene& pending ) {
+    releaseRetired( pending );
+
+    auto& textures{ pending.scene->images };
+    const auto& materials{ pending.cooked->materials };
+    const size_t texturesCount{ std::size( textures ) };
+
+    // each texture is wanted at the largest screen size of the materials sampling it during the last frame
+    std::vector< float > screenSizes( texturesCount );
+    for ( size_t index{ 0U }; index < std::size( materials ); index++ ) {
+        const float coverage{ std::exchange( pending.materialCoverage.at( index ).maxPixels, 0.0F ) };
+        const CookedMaterial& material{ materials.at( index ) };
+        for ( const auto& texture : { material.baseColor, material.normal, material.metalicRoughness } ) {
+            if ( texture.imageIndex < 0 )
+                continue;
+
+            float& screenSize{ screenSizes.at( static_cast< size_t >( texture.imageIndex ) ) };
+            screenSize = std::max( screenSize, coverage );
+        }
+    }
+
+    // textures out of view keep their levels until the budget needs them
+    std::vector< uint32_t > targetLevels( texturesCount );
+    vk::DeviceSize targetSize{};
+    for ( size_t index{ 0U }; index < texturesCount; index++ ) {
+        const auto& texture{ textures.at( index ) };
+        const float screenSize{ screenSizes.at( index ) };
+        if ( screenSize > 0.0F )
+            pending.lastSeenFrames.at( index ) = m_frameIndex;
+
+        targetLevels.at( index ) = screenSize > 0.0F ? texture.getDesiredLevel( screenSize ) : texture.getFirstLevel();
+        targetSize += texture.getResidentSize( targetLevels.at( index ) );
+    }
+
+    // over budget, the textures seen longest ago and then the smallest on screen lose their finest levels first
+    std::vector< size_t > priorities( texturesCount );
+    std::iota( std::begin( priorities ), std::end( priorities ), size_t{ 0U } );
+    std::ranges::sort( priorities, [ &pending, &screenSizes ]( const size_t left, const size_t right ) {
+        return std::tie( pending.lastSeenFrames.at( left ), screenSizes.at( left ) ) <
+               std::tie( pending.lastSeenFrames.at( right ), screenSizes.at( right ) );
+    } );
+
+    for ( const size_t index : priorities ) {
+        const auto& texture{ textures.at( index ) };
+        uint32_t& level{ targetLevels.at( index ) };
+        while ( targetSize > cfg::texture::streamingBudget && level < texture.getTailLevel() ) {
+            targetSize -= texture.getResidentSize( level ) - texture.getResidentSize( level + 1U );
+            level++;
+        }
+    }
 
-    const auto handleVector{ [ & ]( const fastgltf::sources::Vector& vector ) {
-        stbi_uc *data{ stbi_load_from_memory( reinterpret_cast< const stbi_uc * >( std::data( vector.bytes ) ),
-                                              static_cast< int >( std::size( vector.bytes ) ), &width, &height,
-                                              &nrChannels, STBI_rgb_alpha ) };
-        createTextureImage( data );
+    // evictions go first to free memory for the refinements, which come in priority order within the upload budget
+    std::vector< size_t > changes;
+    const auto isCoarsened{ [ &textures, &targetLevels ]( const size_t index ) {
+        return targetLevels.at( index ) > textures.at( index ).getFirstLevel();
     } };
+    const auto isRefined{ [ &textures, &targetLevels ]( const size_t index ) {
+        return targetLevels.at( index ) < textures.at( index ).getFirstLevel();
+    } };
+    std::ranges::copy_if( priorities, std::back_inserter( changes ), isCoarsened );
+    std::ranges::copy_if( priorities | std::views::reverse, std::back_inserter( changes ), isRefined );
+    if ( changes.empty() )
+        return;
+
+    using namespace std::chrono;
+    const auto uploadStart{ high_resolution_clock::now() };
+
+    std::vector< bool > changedTextures( texturesCount );
+    uint64_t uploadedBytes{};
+    size_t changesCount{};
+    for ( ; changesCount < std::size( changes ) && uploadedBytes < cfg::loader::streamingBytesPerFrame;
+          changesCount++ ) {
+        const size_t index{ changes.at( changesCount ) };
+        auto& texture{ textures.at( index ) };
+        auto previousImage{ loadImage( m_uploadBatch, texture, targetLevels.at( index ) ) };
+        if ( previousImage.has_value() )
+            pending.retiredImages.emplace_back( m_frameIndex, std::move( previousImage.value() ) );
+
+        changedTextures.at( index ) = true;
+        uploadedBytes += texture.getResidentSize();
+    }
 
-    const auto handleBufferView{ [ & ]( const fastgltf::sources::BufferView& view ) {
-        auto& bufferView{ asset.bufferViews.at( view.bufferViewIndex ) };
-        auto& buffer{ asset.buffers.at( bufferView.bufferIndex ) };
+    m_uploadBatch.submit();
 
-        const auto handleBufferVector{ [ & ]( const fastgltf::sources::Vector& vector ) {
-            stbi_uc *data{ stbi_load_from_memory(
-                reinterpret_cast< const stbi_uc * >( std::data( vector.bytes ) ) + bufferView.byteOffset,
-                static_cast< int >( bufferView.byteLength ), &width, &height, &nrChannels, STBI_rgb_alpha ) };
-            createTextureImage( data );
-        } };
+    const auto isChanged{ [ &changedTextures ]( const CookedTexture& texture ) {
+        return texture.imageIndex >= 0 && changedTextures.at( static_cast< size_t >( texture.imageIndex ) );
+    } };
+    for ( size_t index{ 0U }; index < std::size( materials ); index++ ) {
+        const CookedMaterial& material{ materials.at( index ) };
+        if ( pending.materialSets.at( index ) && ( isChanged( material.baseColor ) || isChanged( material.normal ) ||
+                                                   isChanged( material.metalicRoughness ) ) )
+            writeSceneMaterial( pending, index );
+    }
 
-        const auto handleBufferArray{ [ & ]( const fastgltf::sources::Array& array ) {
-            stbi_uc *data{ stbi_load_from_memory(
-                reinterpret_cast< const stbi_uc * >( std::data( array.bytes ) ) + bufferView.byteOffset,
-                static_cast< int >( bufferView.byteLength ), &width, &height, &nrChannels, STBI_rgb_alpha ) };
-            createTextureImage( data );
-        } };
+    const duration< float, std::milli > uploadTime{ high_resolution_clock::now() - uploadStart };
+    spdlog::debug( "Texture residency: {} of {} changes applied ({:.1f} MiB) in {:.1f} ms, {:.1f} MiB resident",
+                   changesCount, std::size( changes ), static_cast< float >( uploadedBytes ) / g_mebibyte,
+                   uploadTime.count(), static_cast< float >( getResidentSize( *pending.scene, false ) ) / g_mebibyte );
+}
 
-        std::visit( fastgltf::visitor{ handleBufferVector, handleBufferArray, ignoreRestDataSource }, buffer.data );
+void Loader::releaseRetired( PendingScene& pending ) {
+    // a frame recorded before the retirement may still be executing until its frame slot comes around again
+    const auto isReleasable{ [ this ]( const uint64_t retiredFrame ) {
+        return retiredFrame + g_maxFramesInFlight < m_frameIndex;
     } };
 
-    std::visit( fastgltf::visitor{ handleURI, handleVector, handleBufferView, ignoreRestDataSource }, image.data );
+    while ( !pending.retiredImages.empty() && isReleasable( pending.retiredImages.front().first ) )
+        pending.retiredImages.pop_front();
 
-    return newImage;
+    while ( !pending.retiredSets.empty() && isReleasable( pending.retiredSets.front().first ) ) {
+        pending.freeSets.emplace_back( pending.retiredSets.front().second );
+        pending.retiredSets.pop_front();
+    }
 }
 
-std::optional< fastgltf::Asset > Loader::getAsset( const std::filesystem::path& path ) {
-    constexpr auto loadingOptions{ fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble |
-                                   fastgltf::Options::LoadGLBBuffers | fastgltf::Options::LoadExternalBuffers };
+void Loader::computeImageCacheStats( const CookedScene& cooked, ve::gltf::Scene& scene ) {
+    std::vector< uint32_t > references( std::size( cooked.images ) );
+    std::ranges::for_each( cooked.materials, [ &references ]( const CookedMaterial& material ) {
+        for ( const auto& texture : { material.baseColor, material.normal, material.metalicRoughness } )
+            if ( texture.imageIndex >= 0 )
+                references.at( static_cast< size_t >( texture.imageIndex ) )++;
+    } );
 
-    fastgltf::GltfDataBuffer data;
-    auto expectedData{ fastgltf::GltfDataBuffer::FromPath( path ) };
-    if ( expectedData.error() != fastgltf::Error::None )
-        spdlog::error( "Failed to obtain gltf data buffer: {}", path.string() );
+    auto& cacheStats{ scene.imageCacheStats };
+    for ( size_t imageIndex{ 0U }; imageIndex < std::size( cooked.images ); imageIndex++ ) {
+        const auto& image{ cooked.images.at( imageIndex ) };
+        const uint32_t reusedCount{ std::max( references.at( imageIndex ), 1U ) - 1U };
+        cacheStats.uniqueImages++;
+        cacheStats.reusedImages += reusedCount;
+        cacheStats.savedBytes +=
+            reusedCount * ve::texture::getMipChainSize( image.format, image.extent, getMipLevelsCount( image ) );
+    }
+}
+
+vk::DeviceSize Loader::getResidentSize( const ve::gltf::Scene& scene, const bool isFullyResident ) {
+    vk::DeviceSize size{};
+    std::ranges::for_each( scene.images, [ &size, isFullyResident ]( const ve::StreamingTexture& texture ) {
+        size += isFullyResident ? texture.getResidentSize( 0U ) : texture.getResidentSize();
+    } );
+
+    return size;
+}
 
-    data = std::move( expectedData.get() );
+std::optional< ve::Image > Loader::loadImage( ve::UploadBatch& uploadBatch, ve::StreamingTexture& texture,
+                                              const uint32_t firstLevel ) {
+    auto previousImage{ texture.makeResident( uploadBatch, firstLevel ) };
+    // without batching every image is a submission of its own
+    if constexpr ( !cfg::upload::batchedTextureUploads )
+        uploadBatch.submit();
 
-    const auto objectType{ fastgltf::determineGltfFileType( data ) };
+    return previousImage;
+}
+
+std::optional< Loader::MappedAsset > Loader::getAsset( const std::filesystem::path& path ) {
+    // neither the GLB binary chunk nor external buffers are loaded: accessors and embedded images read them in place
+    // from the mappings, so only the touched pages are ever paged in
+    constexpr auto loadingOptions{ fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble };
+
+    auto mappedFile{ fastgltf::MappedGltfFile::FromPath( path ) };
+    if ( mappedFile.error() != fastgltf::Error::None ) {
+        spdlog::error( "Failed to map gltf file: {}", path.string() );
+        return std::nullopt;
+    }
+
+    MappedAsset mappedAsset;
+    auto& file{ mappedAsset.file.emplace( std::move( mappedFile.get() ) ) };
+
+    fastgltf::Error error{ fastgltf::Error::None };
+    const auto objectType{ fastgltf::determineGltfFileType( file ) };
     switch ( objectType ) {
 
     case fastgltf::GltfType::glTF: {
-        auto loadedAsset{ m_parser.loadGltf( data, path.parent_path(), loadingOptions ) };
-        if ( loadedAsset.error() == fastgltf::Error::None )
-            return std::move( loadedAsset.get() );
+        auto loadedAsset{ m_parser.loadGltf( file, path.parent_path(), loadingOptions ) };
+        error = loadedAsset.error();
+        if ( error == fastgltf::Error::None )
+            mappedAsset.asset = std::move( loadedAsset.get() );
         break;
     }
 
     case fastgltf::GltfType::GLB: {
-        auto loadedAsset{ m_parser.loadGltfBinary( data, path.parent_path(), loadingOptions ) };
-        if ( loadedAsset.error() == fastgltf::Error::None )
-            return std::move( loadedAsset.get() );
+        auto loadedAsset{ m_parser.loadGltfBinary( file, path.parent_path(), loadingOptions ) };
+        error = loadedAsset.error();
+        if ( error == fastgltf::Error::None )
+            mappedAsset.asset = std::move( loadedAsset.get() );
         break;
     }
 
@@ -152,119 +852,402 @@ std::optional< fastgltf::Asset > Loader::getAsset( const std::filesystem::path&
     }
     }
 
-    spdlog::error( "Failed to load model: {}", path.string() );
-    return std::nullopt;
-}
+    if ( error != fastgltf::Error::None ) {
+        spdlog::error( "Failed to load model: {} ({})", path.string(), fastgltf::getErrorMessage( error ) );
+        return std::nullopt;
+    }
 
-Loader::MaterialsOpt Loader::loadMeterials( const fastgltf::Asset& asset, ve::gltf::Scene& scene ) {
-    const std::uint64_t bufferSize{ sizeof( Constants ) * ve::utils::size( asset.materials ) };
-    if ( bufferSize == 0U ) {
-        spdlog::info( "Asset <{}> does not contain any materials", scene.path.filename().string() );
+    if ( !mapExternalBuffers( mappedAsset, path.parent_path() ) )
         return std::nullopt;
+
+    size_t mappedSize{ file.totalSize() };
+    std::ranges::for_each( mappedAsset.buffers,
+                           [ &mappedSize ]( const auto& buffer ) { mappedSize += buffer->size(); } );
+    spdlog::info( "Mapped {} and {} external buffers ({:.1f} MiB)", path.filename().string(),
+                  std::size( mappedAsset.buffers ), static_cast< float >( mappedSize ) / g_mebibyte );
+
+    return mappedAsset;
+}
+
+bool Loader::decodeBufferViews( const fastgltf::Asset& asset ) {
+    using namespace std::chrono;
+    const auto decodingStart{ high_resolution_clock::now() };
+
+    const auto getEncoding{ []( const fastgltf::MeshoptCompressionMode mode ) {
+        switch ( mode ) {
+        case fastgltf::MeshoptCompressionMode::Triangles:
+            return ve::mesh::StreamEncoding::eTriangles;
+        case fastgltf::MeshoptCompressionMode::Indices:
+            return ve::mesh::StreamEncoding::eIndices;
+        default:
+            return ve::mesh::StreamEncoding::eAttributes;
+        }
+    } };
+
+    const auto getFilter{ []( const fastgltf::MeshoptCompressionFilter filter ) {
+        switch ( filter ) {
+        case fastgltf::MeshoptCompressionFilter::Octahedral:
+            return ve::mesh::StreamFilter::eOctahedral;
+        case fastgltf::MeshoptCompressionFilter::Quaternion:
+            return ve::mesh::StreamFilter::eQuaternion;
+        case fastgltf::MeshoptCompressionFilter::Exponential:
+            return ve::mesh::StreamFilter::eExponential;
+        default:
+            return ve::mesh::StreamFilter::eNone;
+        }
+    } };
+
+    // every compressed view is decoded on the pool into its own copy, served to accessors instead of the fallback
+    m_decodedViews.assign( std::size( asset.bufferViews ), {} );
+    std::vector< std::future< bool > > pendingViews;
+    size_t compressedSize{};
+    for ( size_t viewIndex{ 0U }; viewIndex < std::size( asset.bufferViews ); viewIndex++ ) {
+        const auto& compression{ asset.bufferViews.at( viewIndex ).meshoptCompression };
+        if ( compression == nullptr )
+            continue;
+
+        const auto bufferBytes{ getBufferBytes( asset.buffers.at( compression->bufferIndex ) ) };
+        if ( compression->byteOffset + compression->byteLength > std::size( bufferBytes ) ) {
+            spdlog::error( "Compressed buffer view {} is out of its buffer bounds", viewIndex );
+            std::ranges::for_each( pendingViews, []( const auto& pendingView ) { pendingView.wait(); } );
+            return false;
+        }
+
+        const auto source{ bufferBytes.subspan( compression->byteOffset, compression->byteLength ) };
+        auto& decodedView{ m_decodedViews.at( viewIndex ) };
+        decodedView.resize( compression->count * compression->byteStride );
+        compressedSize += std::size( source );
+
+        pendingViews.emplace_back( m_threadPool.submit( [ &compression, &decodedView, source, getEncoding,
+                                                          getFilter ]() {
+            return ve::mesh::decodeStream( decodedView, source, compression->count, compression->byteStride,
+                                           getEncoding( compression->mode ), getFilter( compression->filter ) );
+        } ) );
     }
 
-    scene.images.reserve( std::size( asset.images ) );
+    const auto failedCount{ std::ranges::count_if( pendingViews, []( auto& pendingView ) {
+        return !pendingView.get();
+    } ) };
+    if ( failedCount != 0 ) {
+        spdlog::error( "Failed to decode {} compressed buffer views", failedCount );
+        return false;
+    }
 
-    std::vector< ve::gltf::Material * > tempMaterials;
-    scene.materialDataBuffer.emplace( m_memoryAllocator, bufferSize );
+    if ( pendingViews.empty() )
+        return true;
 
-    Constants *mappedConstanst{ static_cast< Constants * >( scene.materialDataBuffer->getMappedMemory() ) };
-    size_t index{};
-    std::string materialName{};
-    std::ranges::for_each( asset.materials, [ this, &index, &asset, &scene, &tempMaterials, mappedConstanst,
-                                              &materialName ]( const fastgltf::Material& material ) {
-        mappedConstanst[ index ] = loadConstanst( material );
-        const auto materialType{ material.alphaMode == fastgltf::AlphaMode::Blend ? ve::Material::Type::eTransparent
-                                                                                  : ve::Material::Type::eMainColor };
-        const auto resources{ loadResources( index, scene, asset, material ) };
-
-        auto& materialBuilder{ m_engine.getMaterialBuiler() };
-        materialName =
-            material.name.empty() ? std::format( "material{}", std::size( scene.materials ) ) : material.name.c_str();
-        const auto& materialPair{ scene.materials.emplace(
-            materialName,
-            materialBuilder.writeMaterial( materialType, resources, scene.descriptorAllocator.value() ) ) };
-
-        ve::gltf::Material *tempMaterial{ &materialPair.first->second };
-        tempMaterials.emplace_back( tempMaterial );
-
-        index++;
-    } );
+    size_t decodedSize{};
+    std::ranges::for_each( m_decodedViews, [ &decodedSize ]( const auto& view ) { decodedSize += std::size( view ); } );
+
+    const duration< float, std::milli > decodingTime{ high_resolution_clock::now() - decodingStart };
+    spdlog::info( "Decoded {} compressed buffer views ({:.1f} to {:.1f} MiB) on {} threads in {:.1f} ms",
+                  std::size( pendingViews ), static_cast< float >( compressedSize ) / g_mebibyte,
+                  static_cast< float >( decodedSize ) / g_mebibyte, m_threadPool.size(),
+                  decodingTime.count() );
+
+    return true;
+}
+
+bool Loader::mapExternalBuffers( MappedAsset& mappedAsset, const std::filesystem::path& directory ) {
+    for ( auto& buffer : mappedAsset.asset.buffers ) {
+        const auto *source{ std::get_if< fastgltf::sources::URI >( &buffer.data ) };
+        if ( source == nullptr )
+            continue;
+
+        if ( !source->uri.isLocalPath() ) {
+            spdlog::error( "Buffer URI is not a local file: {}", source->uri.string() );
+            return false;
+        }
 
-    return tempMaterials;
+        try {
+            const auto& file{ mappedAsset.buffers.emplace_back(
+                std::make_unique< ve::MappedFile >( directory / source->uri.fspath() ) ) };
+            if ( source->fileByteOffset + buffer.byteLength > file->size() ) {
+                spdlog::error( "Buffer {} is smaller than declared", source->uri.fspath().string() );
+                return false;
+            }
+
+            const fastgltf::sources::ByteView byteView{
+                .bytes{ std::data( file->get() ) + source->fileByteOffset, buffer.byteLength },
+                .mimeType{ source->mimeType } };
+            buffer.data = byteView;
+        } catch ( const std::runtime_error& error ) {
+            spdlog::error( "Failed to map buffer: {}", error.what() );
+            return false;
+        }
+    }
+
+    return true;
 }
 
-std::vector< ve::MeshAsset * > Loader::loadMeshes( const fastgltf::Asset& asset, ve::gltf::Scene& scene ) {
-    const auto materials{ loadMeterials( asset, scene ) };
+void Loader::cookMaterials( const fastgltf::Asset& asset, CookedScene& cooked ) {
+    cooked.materials.reserve( std::size( asset.materials ) );
+
+    std::ranges::for_each( asset.materials, [ this, &asset, &cooked ]( const fastgltf::Material& material ) {
+        const auto cookTexture{ [ & ]( const auto& textureInfo, const ve::texture::Usage usage ) -> CookedTexture {
+            if ( !textureInfo.has_value() )
+                return {};
+
+            const auto& texture{ asset.textures.at( textureInfo->textureIndex ) };
+            const int32_t samplerIndex{
+                texture.samplerIndex.has_value() ? static_cast< int32_t >( texture.samplerIndex.value() ) : -1 };
+
+            // KHR_texture_basisu points at a KTX2 image, the core image is the fallback when it cannot be used
+            for ( const auto& imageIndex : { texture.basisuImageIndex, texture.imageIndex } ) {
+                if ( !imageIndex.has_value() )
+                    continue;
+
+                if ( const auto cookedImage{ cookImage( cooked, imageIndex.value(), usage ) }; cookedImage >= 0 )
+                    return { cookedImage, samplerIndex };
+            }
+
+            return {};
+        } };
+
+        CookedMaterial cookedMaterial{};
+        cookedMaterial.name = material.name.empty() ? std::format( "material{}", std::size( cooked.materials ) )
+                                                    : material.name.c_str();
+        switch ( material.alphaMode ) {
+        case fastgltf::AlphaMode::Blend: {
+            cookedMaterial.type = ve::Material::Type::eTransparent;
+            break;
+        }
+
+        case fastgltf::AlphaMode::Mask: {
+            cookedMaterial.type = ve::Material::Type::eMasked;
+            break;
+        }
 
-    std::vector< uint32_t > indices;
-    std::vector< ve::Vertex > vertices;
+        default: {
+            cookedMaterial.type = ve::Material::Type::eMainColor;
+        }
+        }
+        cookedMaterial.alphaCutoff = material.alphaCutoff;
 
-    std::vector< ve::MeshAsset * > tempMeshes;
-    tempMeshes.reserve( std::size( asset.meshes ) );
+        const auto& baseColorFactor{ material.pbrData.baseColorFactor };
+        cookedMaterial.colorFactors =
+            glm::vec4{ baseColorFactor[ 0 ], baseColorFactor[ 1 ], baseColorFactor[ 2 ], baseColorFactor[ 3 ] };
+        cookedMaterial.metalicRoughnessFactors.x = material.pbrData.metallicFactor;
+        cookedMaterial.metalicRoughnessFactors.y = material.pbrData.roughnessFactor;
 
-    std::string meshName{};
-    std::ranges::for_each( asset.meshes, [ & ]( const auto& mesh ) {
-        meshName = mesh.name.empty() ? std::format( "mesh{}", std::size( scene.meshes ) ) : mesh.name.c_str();
-        ve::MeshAsset& newMesh{ scene.meshes.emplace( meshName, ve::MeshAsset{} ).first->second };
-        tempMeshes.emplace_back( &newMesh );
+        cookedMaterial.baseColor = cookTexture( material.pbrData.baseColorTexture, ve::texture::Usage::eColor );
+        cookedMaterial.normal    = cookTexture( material.normalTexture, ve::texture::Usage::eNormal );
+        cookedMaterial.metalicRoughness =
+            cookTexture( material.pbrData.metallicRoughnessTexture, ve::texture::Usage::eData );
 
-        indices.clear();
-        vertices.clear();
+        cooked.materials.emplace_back( std::move( cookedMaterial ) );
+    } );
+}
 
-        std::ranges::for_each( mesh.primitives, [ this, &indices, &vertices, &asset, &materials,
-                                                  &newMesh ]( const auto& primitive ) {
-            ve::Surface surface;
+void Loader::cookMeshes( const fastgltf::Asset& asset, CookedScene& cooked ) {
+    using namespace std::chrono;
+    const auto assemblyStart{ high_resolution_clock::now() };
+
+    auto& indices{ cooked.indexStorage };
+    auto& vertices{ cooked.vertexStorage };
+    cooked.meshes.reserve( std::size( asset.meshes ) );
+    size_t primitivesCount{};
+    uint64_t trianglesCount{};
+    uint64_t transformedBefore{};
+    uint64_t transformedAfter{};
+    uint64_t verticesBefore{};
+    uint64_t verticesAfter{};
+    uint64_t fullTrianglesCount{};
+    std::array< uint64_t, ve::g_maxSurfaceLods > lodTrianglesCounts{};
+
+    std::ranges::for_each( asset.meshes, [ & ]( const fastgltf::Mesh& mesh ) {
+        CookedMesh& newMesh{ cooked.meshes.emplace_back() };
+        newMesh.name = mesh.name.empty() ? std::format( "mesh{}", std::size( cooked.meshes ) - 1U ) : mesh.name.c_str();
+        newMesh.firstSurface = ve::utils::size( cooked.surfaces );
+        newMesh.firstVertex  = ve::utils::size( vertices );
+
+        std::ranges::for_each( mesh.primitives, [ & ]( const fastgltf::Primitive& primitive ) {
+            CookedSurface surface;
             surface.startIndex = ve::utils::size( indices );
             surface.count = static_cast< uint32_t >( asset.accessors.at( primitive.indicesAccessor.value() ).count );
+            surface.materialIndex =
+                primitive.materialIndex.has_value() ? static_cast< int32_t >( primitive.materialIndex.value() ) : -1;
 
             size_t initialIndex{ std::size( vertices ) };
-            loadIndices( initialIndex, indices, asset, primitive );
+            loadIndices( indices, asset, primitive );
             loadVertices( initialIndex, vertices, asset, primitive );
-            loadNormals( initialIndex, vertices, asset, primitive );
-            loadTextureCoord( initialIndex, vertices, asset, primitive );
-            loadColor( initialIndex, vertices, asset, primitive );
-            loadTangent( initialIndex, vertices, asset, primitive );
+            primitivesCount++;
+
+            // indices stay relative to the primitive until its triangles and vertices are reordered
+            const auto surfaceIndices{ std::span{ indices }.subspan( surface.startIndex ) };
+            if constexpr ( cfg::geometry::optimizeIndices ) {
+                const auto surfaceVertices{ std::span{ vertices }.subspan( initialIndex ) };
+                const auto before{ ve::mesh::analyzeVertexCache( surfaceIndices, std::size( surfaceVertices ) ) };
+                const size_t usedVerticesCount{ ve::mesh::optimizeSurface( surfaceIndices, surfaceVertices,
+                                                                            cfg::geometry::reduceOverdraw ) };
+                const auto after{ ve::mesh::analyzeVertexCache( surfaceIndices, usedVerticesCount ) };
+                vertices.resize( initialIndex + usedVerticesCount );
+
+                spdlog::debug( "Surface {} of {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                               std::size( cooked.surfaces ) - newMesh.firstSurface, newMesh.name, before.acmr,
+                               after.acmr, before.atvr, after.atvr );
+                trianglesCount += std::size( surfaceIndices ) / 3U;
+                transformedBefore += before.verticesTransformed;
+                transformedAfter += after.verticesTransformed;
+                verticesBefore += std::size( surfaceVertices );
+                verticesAfter += usedVerticesCount;
+            }
 
-            if ( primitive.materialIndex.has_value() && materials.has_value() ) {
-                surface.material.emplace( *materials->at( primitive.materialIndex.value() ) );
-            } else {
-                surface.material.emplace( m_engine.getDefaultMaterial() );
+            std::vector< ve::mesh::SimplifiedSurface > lods;
+            if constexpr ( cfg::geometry::lods ) {
+                const auto surfaceVertices{ std::span{ vertices }.subspan( initialIndex ) };
+                lods = ve::mesh::simplifySurface( surfaceIndices, surfaceVertices, ve::g_maxSurfaceLods );
+                fullTrianglesCount += std::size( surfaceIndices ) / 3U;
+            }
+
+            surface.bounds = ve::mesh::computeBounds( std::span{ vertices }.subspan( initialIndex ) );
+
+            const auto baseVertex{ static_cast< uint32_t >( initialIndex - newMesh.firstVertex ) };
+            const auto rebase{ [ baseVertex ]( uint32_t& index ) { index += baseVertex; } };
+            std::ranges::for_each( surfaceIndices, rebase );
+
+            // simplified levels follow the surface in the index array and address the same vertices
+            for ( auto& lod : lods ) {
+                std::ranges::for_each( lod.indices, rebase );
+                surface.lods.at( surface.lodsCount++ ) = ve::SurfaceLod{ .startIndex{ ve::utils::size( indices ) },
+                                                                         .count{ ve::utils::size( lod.indices ) },
+                                                                         .error{ lod.error } };
+                indices.insert( std::end( indices ), std::begin( lod.indices ), std::end( lod.indices ) );
+                lodTrianglesCounts.at( surface.lodsCount - 1U ) += std::size( lod.indices ) / 3U;
             }
 
-            newMesh.surfaces.emplace_back( surface );
+            cooked.surfaces.emplace_back( surface );
         } );
 
-        newMesh.buffers = m_engine.uploadMeshBuffers( vertices, indices );
-        newMesh.name    = meshName;
+        newMesh.surfacesCount  = ve::utils::size( cooked.surfaces ) - newMesh.firstSurface;
+        newMesh.verticesCount  = ve::utils::size( vertices ) - newMesh.firstVertex;
+        newMesh.boundingSphere =
+            ve::mesh::computeBoundingSphere( std::span{ vertices }.subspan( newMesh.firstVertex ) );
     } );
 
-    return tempMeshes;
+    cooked.vertices = vertices;
+    cooked.indices  = indices;
+
+    const duration< float, std::milli > assemblyTime{ high_resolution_clock::now() - assemblyStart };
+    spdlog::info( "Assembled {} vertices and {} indices of {} primitives in {:.2f} ms", std::size( vertices ),
+                  std::size( indices ), primitivesCount, assemblyTime.count() );
+
+    if ( trianglesCount > 0U ) {
+        const auto toRatio{ []( const uint64_t numerator, const uint64_t denominator ) {
+            return static_cast< float >( numerator ) / static_cast< float >( std::max( denominator, uint64_t{ 1U } ) );
+        } };
+        spdlog::info( "Vertex cache ({} entries): ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                      ve::mesh::g_vertexCacheSize, toRatio( transformedBefore, trianglesCount ),
+                      toRatio( transformedAfter, trianglesCount ), toRatio( transformedBefore, verticesBefore ),
+                      toRatio( transformedAfter, verticesAfter ) );
+    }
+
+    for ( size_t level{ 0U }; level < std::size( lodTrianglesCounts ) && fullTrianglesCount > 0U; level++ ) {
+        const auto levelTrianglesCount{ lodTrianglesCounts.at( level ) };
+        const float percentage{ 100.0F * static_cast< float >( levelTrianglesCount ) /
+                                static_cast< float >( fullTrianglesCount ) };
+        spdlog::info( "Surface LOD {}: {} of {} triangles ({:.1f}%)", level + 1U, levelTrianglesCount,
+                      fullTrianglesCount, percentage );
+    }
 }
 
-std::vector< std::shared_ptr< ve::Node > > Loader::loadNodes( const fastgltf::Asset& asset, ve::gltf::Scene& scene ) {
-    const auto meshes{ loadMeshes( asset, scene ) };
-    std::vector< std::shared_ptr< ve::Node > > tempNodes;
-    tempNodes.reserve( std::size( asset.nodes ) );
+void Loader::packVertices( CookedScene& cooked ) {
+    auto& packedVertices{ cooked.packedVertexStorage };
+    packedVertices.resize( std::size( cooked.vertexStorage ) );
 
-    std::string nodeName{};
-    std::ranges::for_each( asset.nodes, [ &meshes, &tempNodes, &scene, &nodeName ]( const fastgltf::Node& node ) {
-        std::shared_ptr< ve::Node > newNode;
-        if ( node.meshIndex.has_value() ) {
-            const ve::MeshAsset& asset{ *meshes.at( node.meshIndex.value() ) };
-            newNode = std::make_shared< ve::MeshNode >( asset );
-        } else {
-            newNode = std::make_shared< ve::Node >();
-        }
+    std::ranges::for_each( cooked.meshes, [ &cooked, &packedVertices ]( CookedMesh& mesh ) {
+        const auto vertices{ std::span{ cooked.vertexStorage }.subspan( mesh.firstVertex, mesh.verticesCount ) };
+        if ( vertices.empty() )
+            return;
+
+        glm::vec3 minPosition{ vertices.front().position };
+        glm::vec3 maxPosition{ minPosition };
+        std::ranges::for_each( vertices, [ &minPosition, &maxPosition ]( const ve::Vertex& vertex ) {
+            minPosition = glm::min( minPosition, vertex.position );
+            maxPosition = glm::max( maxPosition, vertex.position );
+        } );
+
+        // flat meshes keep a non-zero scale on the collapsed axis, every position there quantizes to zero
+        const glm::vec3 positionScale{ glm::max( maxPosition - minPosition,
+                                                 glm::vec3{ std::numeric_limits< float >::min() } ) };
+        mesh.positionOffset = glm::vec4{ minPosition, 0.0F };
+        mesh.positionScale  = glm::vec4{ positionScale, 0.0F };
+
+        std::ranges::transform( vertices, std::begin( packedVertices ) + mesh.firstVertex,
+                                [ &minPosition, &positionScale ]( const ve::Vertex& vertex ) {
+                                    return packVertex( vertex, minPosition, positionScale );
+                                } );
+    } );
+
+    spdlog::info( "Packed {} vertices: {:.1f} MiB -> {:.1f} MiB", std::size( packedVertices ),
+                  static_cast< float >( std::size( cooked.vertexStorage ) * sizeof( ve::Vertex ) ) / g_mebibyte,
+                  static_cast< float >( std::size( packedVertices ) * sizeof( ve::PackedVertex ) ) / g_mebibyte );
+
+    cooked.packedVertices = packedVertices;
+    cooked.vertices       = {};
+    cooked.vertexStorage  = {};
+}
+
+void Loader::narrowIndices( CookedScene& cooked ) {
+    static constexpr size_t shortIndexLimit{ size_t{ std::numeric_limits< uint16_t >::max() } + 1U };
+
+    std::vector< uint32_t > wideIndices;
+    auto& shortIndices{ cooked.shortIndexStorage };
+    size_t shortMeshesCount{};
+
+    // mesh indices are relative to the mesh first vertex, so its vertex count decides the index type
+    std::ranges::for_each( cooked.meshes, [ & ]( CookedMesh& mesh ) {
+        const bool isShort{ mesh.verticesCount < shortIndexLimit };
+        mesh.indexType = isShort ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+        shortMeshesCount += isShort ? 1U : 0U;
+
+        const auto moveRange{ [ & ]( uint32_t& startIndex, const uint32_t count ) {
+            const auto source{ std::span{ cooked.indexStorage }.subspan( startIndex, count ) };
+            if ( isShort ) {
+                startIndex = ve::utils::size( shortIndices );
+                std::ranges::transform( source, std::back_inserter( shortIndices ),
+                                        []( const uint32_t index ) { return static_cast< uint16_t >( index ); } );
+            } else {
+                startIndex = ve::utils::size( wideIndices );
+                wideIndices.insert( std::end( wideIndices ), std::begin( source ), std::end( source ) );
+            }
+        } };
+
+        auto surfaces{ std::span{ cooked.surfaces }.subspan( mesh.firstSurface, mesh.surfacesCount ) };
+        std::ranges::for_each( surfaces, [ &moveRange ]( CookedSurface& surface ) {
+            moveRange( surface.startIndex, surface.count );
+            for ( auto& lod : std::span{ surface.lods }.first( surface.lodsCount ) )
+                moveRange( lod.startIndex, lod.count );
+        } );
+    } );
+
+    const size_t wideSize{ std::size( cooked.indexStorage ) * sizeof( uint32_t ) };
+    const size_t narrowedSize{ std::size( wideIndices ) * sizeof( uint32_t ) +
+                               std::size( shortIndices ) * sizeof( uint16_t ) };
+    spdlog::info( "{} of {} meshes use 16-bit indices: {:.1f} MiB -> {:.1f} MiB", shortMeshesCount,
+                  std::size( cooked.meshes ), static_cast< float >( wideSize ) / g_mebibyte,
+                  static_cast< float >( narrowedSize ) / g_mebibyte );
+
+    cooked.indexStorage = std::move( wideIndices );
+    cooked.indices      = cooked.indexStorage;
+    cooked.shortIndices = shortIndices;
+}
+
+void Loader::cookNodes( const fastgltf::Asset& asset, CookedScene& cooked ) {
+    cooked.nodes.resize( std::size( asset.nodes ) );
+
+    for ( size_t index{ 0 }; index < std::size( asset.nodes ); index++ ) {
+        const fastgltf::Node& node{ asset.nodes.at( index ) };
+        CookedNode& cookedNode{ cooked.nodes.at( index ) };
 
-        tempNodes.emplace_back( newNode );
+        cookedNode.name = node.name.empty() ? std::format( "node{}", index ) : node.name.c_str();
+        cookedNode.meshIndex = node.meshIndex.has_value() ? static_cast< int32_t >( node.meshIndex.value() ) : -1;
 
-        const auto matrix{ [ &newNode ]( const fastgltf::math::fmat4x4& matrix ) {
-            glm::mat4& localTransform{ newNode->getLocalTransform() };
-            memcpy( &localTransform, std::data( matrix ), sizeof( matrix ) );
+        const auto matrix{ [ &cookedNode ]( const fastgltf::math::fmat4x4& matrix ) {
+            memcpy( &cookedNode.localTransform, std::data( matrix ), sizeof( matrix ) );
         } };
 
-        const auto transform{ [ &newNode ]( const fastgltf::TRS& transform ) {
+        const auto transform{ [ &cookedNode ]( const fastgltf::TRS& transform ) {
             const glm::vec3 translation( transform.translation[ 0 ], transform.translation[ 1 ],
                                          transform.translation[ 2 ] );
             const glm::quat rotation( transform.rotation[ 3 ], transform.rotation[ 0 ], transform.rotation[ 1 ],
@@ -275,89 +1258,251 @@ std::vector< std::shared_ptr< ve::Node > > Loader::loadNodes( const fastgltf::As
             const glm::mat4 rotationMat{ glm::toMat4( rotation ) };
             const glm::mat4 scaleMat{ glm::scale( glm::mat4( 1.f ), scale ) };
 
-            newNode->setLocalTransform( translationMat * rotationMat * scaleMat );
+            cookedNode.localTransform = translationMat * rotationMat * scaleMat;
         } };
 
         const fastgltf::visitor visitor{ matrix, transform };
         std::visit( visitor, node.transform );
 
-        nodeName = node.name.empty() ? std::format( "node{}", std::size( scene.nodes ) ) : node.name.c_str();
-        scene.nodes.emplace( nodeName, newNode );
-    } );
+        if ( node.meshIndex.has_value() )
+            cookInstances( asset, node, cooked, cookedNode );
 
-    return tempNodes;
+        std::ranges::for_each( node.children, [ &cooked, index ]( const size_t childNodeIndex ) {
+            cooked.nodes.at( childNodeIndex ).parentIndex = static_cast< int32_t >( index );
+        } );
+    }
 }
 
-void Loader::setNodesRalationship( const fastgltf::Asset& asset, ve::gltf::Scene& scene ) {
-    const auto tempNodes{ loadNodes( asset, scene ) };
+void Loader::cookInstances( const fastgltf::Asset& asset, const fastgltf::Node& node, CookedScene& cooked,
+                            CookedNode& cookedNode ) const {
+    const auto findAccessor{ [ &asset, &node ]( const std::string_view name ) -> const fastgltf::Accessor * {
+        const auto attribute{ std::ranges::find_if(
+            node.instancingAttributes, [ name ]( const auto& attribute ) { return attribute.name == name; } ) };
+        if ( attribute == std::end( node.instancingAttributes ) )
+            return nullptr;
 
-    for ( size_t index{ 0 }; index < std::size( asset.nodes ); index++ ) {
-        const fastgltf::Node& node{ asset.nodes.at( index ) };
-        std::shared_ptr< Node > sceneNode{ tempNodes.at( index ) };
+        return &asset.accessors.at( attribute->accessorIndex );
+    } };
+
+    const auto *translations{ findAccessor( "TRANSLATION" ) };
+    const auto *rotations{ findAccessor( "ROTATION" ) };
+    const auto *scales{ findAccessor( "SCALE" ) };
+    const auto *anyAttribute{ translations != nullptr ? translations : rotations != nullptr ? rotations : scales };
+    if ( anyAttribute == nullptr || anyAttribute->count == 0U )
+        return;
+
+    // instance transforms are T * R * S like node transforms, missing attributes stay identity
+    auto& transforms{ cooked.instanceTransformStorage };
+    cookedNode.firstInstance  = ve::utils::size( transforms );
+    cookedNode.instancesCount = static_cast< uint32_t >( anyAttribute->count );
+    transforms.resize( std::size( transforms ) + anyAttribute->count, glm::mat4{ 1.0F } );
+    const auto instances{ std::span{ transforms }.subspan( cookedNode.firstInstance ) };
+    const BufferViewAdapter adapter{ m_decodedViews };
+
+    if ( translations != nullptr )
+        fastgltf::iterateAccessorWithIndex< glm::vec3 >(
+            asset, *translations, [ &instances ]( const glm::vec3 translation, const size_t index ) {
+                if ( index < std::size( instances ) )
+                    instances[ index ] = glm::translate( instances[ index ], translation );
+            },
+            adapter );
+
+    if ( rotations != nullptr )
+        fastgltf::iterateAccessorWithIndex< glm::vec4 >(
+            asset, *rotations, [ &instances ]( const glm::vec4 rotation, const size_t index ) {
+                if ( index < std::size( instances ) )
+                    instances[ index ] *= glm::toMat4( glm::quat{ rotation.w, rotation.x, rotation.y, rotation.z } );
+            },
+            adapter );
+
+    if ( scales != nullptr )
+        fastgltf::iterateAccessorWithIndex< glm::vec3 >(
+            asset, *scales, [ &instances ]( const glm::vec3 scale, const size_t index ) {
+                if ( index < std::size( instances ) )
+                    instances[ index ] = glm::scale( instances[ index ], scale );
+            },
+            adapter );
+
+    const glm::vec4 meshSphere{ cooked.meshes.at( static_cast< size_t >( cookedNode.meshIndex ) ).boundingSphere };
+    cookedNode.instancesBoundingSphere = ve::mesh::computeBoundingSphere( meshSphere, instances );
+    cooked.instanceTransforms          = transforms;
+}
+
+void Loader::loadMaterialConstants( const CookedScene& cooked, ve::gltf::Scene& scene ) {
+    const std::uint64_t bufferSize{ sizeof( Constants ) * ve::utils::size( cooked.materials ) };
+    if ( bufferSize == 0U ) {
+        spdlog::info( "Asset <{}> does not contain any materials", scene.path.filename().string() );
+        return;
+    }
+
+    scene.materialDataBuffer.emplace( m_memoryAllocator, bufferSize );
+    Constants *mappedConstanst{ static_cast< Constants * >( scene.materialDataBuffer->getMappedMemory() ) };
+    std::ranges::transform( cooked.materials, mappedConstanst,
+                            [ this ]( const CookedMaterial& material ) { return loadConstanst( material ); } );
+}
+
+void Loader::loadMeshes( PendingScene& pending ) {
+    const CookedScene& cooked{ pending.cooked.value() };
+    ve::gltf::Scene& scene{ *pending.scene };
+
+    // surfaces are referenced by pointer from here on, so the meshes are never reallocated
+    scene.meshes.reserve( std::size( cooked.meshes ) );
+
+    std::ranges::for_each( cooked.meshes, [ this, &cooked, &scene, &pending ]( const auto& mesh ) {
+        ve::MeshAsset& newMesh{ scene.meshes.emplace_back() };
+
+        newMesh.firstVertex    = mesh.firstVertex;
+        newMesh.verticesCount  = mesh.verticesCount;
+        newMesh.positionOffset = mesh.positionOffset;
+        newMesh.positionScale  = mesh.positionScale;
+        newMesh.boundingSphere = mesh.boundingSphere;
+        newMesh.indexType      = mesh.indexType;
+        newMesh.name           = mesh.name;
+
+        // every surface starts with the default material, resolveMaterials() swaps in its own one
+        const auto surfaces{ std::span{ cooked.surfaces }.subspan( mesh.firstSurface, mesh.surfacesCount ) };
+        std::ranges::for_each( surfaces, [ this, &pending, &newMesh ]( const CookedSurface& cookedSurface ) {
+            ve::ScreenCoverage *coverage{ nullptr };
+            if ( cookedSurface.materialIndex >= 0 ) {
+                const auto materialIndex{ static_cast< size_t >( cookedSurface.materialIndex ) };
+                pending.materialSurfaces.at( materialIndex ).emplace_back( &newMesh, std::size( newMesh.surfaces ) );
+                if constexpr ( cfg::texture::mipStreaming )
+                    coverage = &pending.materialCoverage.at( materialIndex );
+            }
 
-        std::ranges::for_each( node.children, [ &sceneNode, &tempNodes ]( const auto& childNodeIndex ) {
-            sceneNode->addChild( tempNodes.at( childNodeIndex ) );
-            tempNodes.at( childNodeIndex )->setParent( sceneNode );
+            ve::Surface& surface{ newMesh.surfaces.emplace_back() };
+            surface.startIndex    = cookedSurface.startIndex;
+            surface.count         = cookedSurface.count;
+            surface.lods          = cookedSurface.lods;
+            surface.lodsCount     = cookedSurface.lodsCount;
+            surface.bounds        = cookedSurface.bounds;
+            surface.coverage      = coverage;
+            surface.materialIndex = cookedSurface.materialIndex;
+            surface.material.emplace( m_engine.getDefaultMaterial() );
         } );
+    } );
+
+    const bool isPacked{ !cooked.packedVertices.empty() };
+    const auto vertexData{ isPacked ? std::as_bytes( cooked.packedVertices ) : std::as_bytes( cooked.vertices ) };
+    if ( ( cooked.indices.empty() && cooked.shortIndices.empty() ) || vertexData.empty() )
+        return;
+
+    // the first instance transform is the identity used by nodes which are not instanced
+    std::vector< glm::mat4 > instanceTransforms{ glm::mat4{ 1.0F } };
+    instanceTransforms.insert( std::end( instanceTransforms ), std::begin( cooked.instanceTransforms ),
+                               std::end( cooked.instanceTransforms ) );
+
+    scene.geometryBuffers =
+        m_engine.uploadMeshBuffers( vertexData, cooked.indices, cooked.shortIndices, instanceTransforms );
+    const auto& geometryBuffers{ scene.geometryBuffers };
+    const vk::DeviceSize vertexStride{ isPacked ? sizeof( ve::PackedVertex ) : sizeof( ve::Vertex ) };
+    std::ranges::for_each( scene.meshes, [ &geometryBuffers, vertexStride ]( ve::MeshAsset& mesh ) {
+        mesh.indexBuffer         = geometryBuffers.indexBuffer->get();
+        mesh.indexBufferOffset   = mesh.indexType == vk::IndexType::eUint16 ? geometryBuffers.shortIndexOffset : 0U;
+        mesh.vertexBufferAddress = geometryBuffers.vertexBufferAddress + mesh.firstVertex * vertexStride;
+    } );
+
+    spdlog::info( "Scene geometry: {} meshes sharing {} {}vertices ({} bytes each), {} 32-bit and {} 16-bit indices",
+                  std::size( scene.meshes ), std::size( vertexData ) / vertexStride, isPacked ? "packed " : "",
+                  vertexStride, std::size( cooked.indices ), std::size( cooked.shortIndices ) );
+    if ( !cooked.instanceTransforms.empty() )
+        spdlog::info( "Scene instancing: {} instance transforms", std::size( cooked.instanceTransforms ) );
+}
+
+void Loader::loadNodes( const CookedScene& cooked, ve::gltf::Scene& scene ) {
+    // glTF nodes may come in any order, the scene graph wants parents first, so the nodes are laid out breadth
+    // first from the roots; nodes caught in a parent cycle are never reached and get dropped
+    const size_t nodesCount{ std::size( cooked.nodes ) };
+    std::vector< std::vector< uint32_t > > children( nodesCount );
+    std::vector< uint32_t > order;
+    order.reserve( nodesCount );
+    for ( uint32_t index{ 0U }; index < nodesCount; index++ ) {
+        const int32_t parentIndex{ cooked.nodes.at( index ).parentIndex };
+        if ( parentIndex < 0 )
+            order.emplace_back( index );
+        else
+            children.at( static_cast< size_t >( parentIndex ) ).emplace_back( index );
+    }
+
+    for ( size_t position{ 0U }; position < std::size( order ); position++ ) {
+        const auto& nodeChildren{ children.at( order.at( position ) ) };
+        order.insert( std::end( order ), std::begin( nodeChildren ), std::end( nodeChildren ) );
     }
 
-    std::ranges::for_each( tempNodes, [ &scene ]( auto& node ) {
-        if ( node->getParent().lock() == nullptr ) {
-            scene.topNodes.emplace_back( node );
-            node->refreshWorldTransform( glm::mat4{ 1.0F } );
+    const auto instancesAddress{ scene.geometryBuffers.instanceBufferAddress };
+    std::vector< uint32_t > graphIndices( nodesCount, ve::SceneGraph::g_noParent );
+    scene.graph.reserve( std::size( order ) );
+    std::ranges::for_each( order, [ &cooked, &scene, &graphIndices, instancesAddress ]( const uint32_t index ) {
+        const CookedNode& node{ cooked.nodes.at( index ) };
+        const uint32_t parent{ node.parentIndex < 0 ? ve::SceneGraph::g_noParent
+                                                    : graphIndices.at( static_cast< size_t >( node.parentIndex ) ) };
+        const uint32_t graphIndex{ scene.graph.addNode( parent, node.localTransform ) };
+        graphIndices.at( index ) = graphIndex;
+        scene.nodes.emplace( node.name, graphIndex );
+
+        if ( node.meshIndex < 0 )
+            return;
+
+        const ve::MeshAsset& asset{ scene.meshes.at( static_cast< size_t >( node.meshIndex ) ) };
+        const bool isInstanced{ node.instancesCount > 0U };
+        const uint32_t firstTransform{ isInstanced ? node.firstInstance + 1U : 0U };
+
+        ve::MeshInstances instances;
+        instances.transformsAddress = instancesAddress + firstTransform * sizeof( glm::mat4 );
+        instances.count             = std::max( node.instancesCount, 1U );
+        instances.boundingSphere    = isInstanced ? node.instancesBoundingSphere : asset.boundingSphere;
+        if ( isInstanced ) {
+            instances.isInstanced = true;
+            instances.maxScale    = 0.0F;
+            std::ranges::for_each( cooked.instanceTransforms.subspan( node.firstInstance, node.instancesCount ),
+                                   [ &instances ]( const glm::mat4& transform ) {
+                                       instances.maxScale =
+                                           std::max( instances.maxScale, ve::mesh::getMaxScale( transform ) );
+                                   } );
         }
+
+        scene.meshNodes.emplace_back( graphIndex, static_cast< uint32_t >( node.meshIndex ), instances );
     } );
+
+    spdlog::info( "Scene graph: {} nodes ({} unreachable), {} mesh nodes", scene.graph.size(),
+                  nodesCount - std::size( order ), std::size( scene.meshNodes ) );
 }
 
-Loader::Constants Loader::loadConstanst( const fastgltf::Material& material ) {
+Loader::Constants Loader::loadConstanst( const CookedMaterial& material ) {
     Constants constanst;
-    constanst.colorFactors.x = material.pbrData.baseColorFactor[ 0 ];
-    constanst.colorFactors.y = material.pbrData.baseColorFactor[ 1 ];
-    constanst.colorFactors.z = material.pbrData.baseColorFactor[ 2 ];
-    constanst.colorFactors.w = material.pbrData.baseColorFactor[ 3 ];
-
-    constanst.metalicRoughnessFactors.x = material.pbrData.metallicFactor;
-    constanst.metalicRoughnessFactors.y = material.pbrData.roughnessFactor;
+    constanst.colorFactors            = material.colorFactors;
+    constanst.metalicRoughnessFactors = material.metalicRoughnessFactors;
+    constanst.alphaFactors            = glm::vec4{ material.alphaCutoff, 0.0F, 0.0F, 0.0F };
 
     return constanst;
 }
 
-Loader::Resources Loader::loadResources( const size_t index, ve::gltf::Scene& scene, const fastgltf::Asset& asset,
-                                         const fastgltf::Material& material ) {
+Loader::Resources Loader::loadResources( const size_t index, ve::gltf::Scene& scene, const CookedMaterial& material ) {
     const auto defaultImageView{ m_engine.getDefaultImage().getImageView() };
     const auto defaultSampler{ m_engine.getDefaultSampler().get() };
     const auto uniformBufferOffset{ index * sizeof( Constants ) };
 
     Resources resources;
-    resources.metalicRoughnessImageView = defaultImageView;
-    resources.metalicRoughnessSampler   = defaultSampler;
-    resources.dataBuffer                = scene.materialDataBuffer->get();
-    resources.dataBufferOffset          = uniformBufferOffset;
+    resources.dataBuffer       = scene.materialDataBuffer->get();
+    resources.dataBufferOffset = uniformBufferOffset;
 
     const auto getImageViewAndSampler{
-        [ & ]( const auto& textureInfo, const vk::Format textureFormat ) -> std::pair< vk::ImageView, vk::Sampler > {
-            if ( textureInfo.has_value() ) {
-                const size_t textureIndex{ textureInfo->textureIndex };
-                const size_t imageIndex{ asset.textures.at( textureIndex ).imageIndex.value() };
-                const auto samplerIndexOpt{ asset.textures[ textureIndex ].samplerIndex };
-
-                const auto& loadedImage{ scene.images.emplace_back(
-                    *loadImage( asset, scene, asset.images.at( imageIndex ), textureFormat ) ) };
-
-                return { loadedImage.getImageView(), samplerIndexOpt.has_value()
-                                                         ? scene.samplers.at( samplerIndexOpt.value() ).get()
-                                                         : defaultSampler };
-            }
+        [ & ]( const CookedTexture& texture ) -> std::pair< vk::ImageView, vk::Sampler > {
+            if ( texture.imageIndex < 0 )
+                return { defaultImageView, defaultSampler };
 
-            return { defaultImageView, defaultSampler };
+            const auto& sceneImage{ scene.images.at( static_cast< size_t >( texture.imageIndex ) ).getImage() };
+            if ( texture.samplerIndex < 0 )
+                return { sceneImage.getImageView(), defaultSampler };
+
+            return { sceneImage.getImageView(),
+                     scene.samplers.at( static_cast< size_t >( texture.samplerIndex ) ).get() };
         } };
 
-    const auto [ baseColorView, colorSampler ]{
-        getImageViewAndSampler( material.pbrData.baseColorTexture, vk::Format::eR8G8B8A8Srgb ) };
-    const auto [ normalView,
-                 normalSampler ]{ getImageViewAndSampler( material.normalTexture, vk::Format::eR8G8B8A8Unorm ) };
-    const auto [ metallicRoughnessView, metallicRoughnessSampler ]{
-        getImageViewAndSampler( material.pbrData.metallicRoughnessTexture, vk::Format::eR8G8B8A8Unorm ) };
+    const auto [ baseColorView, colorSampler ]{ getImageViewAndSampler( material.baseColor ) };
+    const auto [ normalView, normalSampler ]{ getImageViewAndSampler( material.normal ) };
+    const auto [ metallicRoughnessView,
+                 metallicRoughnessSampler ]{ getImageViewAndSampler( material.metalicRoughness ) };
 
     resources.colorImageView            = baseColorView;
     resources.normalMapView             = normalView;
@@ -369,82 +1514,56 @@ Loader::Resources Loader::loadResources( const size_t index, ve::gltf::Scene& sc
     return resources;
 }
 
-void Loader::loadIndices( const size_t initialIndex, std::vector< uint32_t >& indices, const fastgltf::Asset& asset,
+void Loader::loadIndices( std::vector< uint32_t >& indices, const fastgltf::Asset& asset,
                           const fastgltf::Primitive& primitive ) {
     const fastgltf::Accessor& indexAccessor{ asset.accessors.at( primitive.indicesAccessor.value() ) };
-    indices.reserve( indices.size() + indexAccessor.count );
-
-    fastgltf::iterateAccessor< uint32_t >( asset, indexAccessor, [ &indices, initialIndex ]( const uint32_t index ) {
-        indices.push_back( index + initialIndex );
-    } );
+    const size_t firstIndex{ std::size( indices ) };
+    indices.resize( firstIndex + indexAccessor.count );
+    fastgltf::copyFromAccessor< uint32_t >( asset, indexAccessor, std::data( indices ) + firstIndex,
+                                            BufferViewAdapter{ m_decodedViews } );
 }
 
 void Loader::loadVertices( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
                            const fastgltf::Primitive& primitive ) {
-    const auto accessorIndex{ primitive.findAttribute( "POSITION" )->accessorIndex };
-    const fastgltf::Accessor& positionAccessor{ asset.accessors.at( accessorIndex ) };
-    vertices.resize( std::size( vertices ) + positionAccessor.count );
-
-    fastgltf::iterateAccessorWithIndex< glm::vec3 >(
-        asset, positionAccessor, [ initialIndex, &vertices ]( const glm::vec3 position, const size_t index ) {
-            Vertex vertex{};
-            vertex.position                     = position;
-            vertices.at( initialIndex + index ) = vertex;
-        } );
-}
-
-void Loader::loadNormals( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                          const fastgltf::Primitive& primitive ) {
-    const auto normals{ primitive.findAttribute( "NORMAL" ) };
-
-    if ( normals != std::end( primitive.attributes ) ) {
-        const auto accessorNormalIndex{ ( *normals ).accessorIndex };
-        const auto& normalAccessor{ asset.accessors.at( accessorNormalIndex ) };
-
-        fastgltf::iterateAccessorWithIndex< glm::vec3 >(
-            asset, normalAccessor, [ &initialIndex, &vertices ]( const glm::vec3 normal, const size_t index ) {
-                vertices.at( initialIndex + index ).normal = normal;
-            } );
+    auto& streams{ m_attributeStreams };
+    const auto& positionAccessor{ asset.accessors.at( primitive.findAttribute( "POSITION" )->accessorIndex ) };
+    const size_t count{ positionAccessor.count };
+
+    // every attribute is copied into its own tightly packed stream first, which takes the memcpy path for
+    // plain float data, then all streams are interleaved in a single pass over the vertices
+    const BufferViewAdapter adapter{ m_decodedViews };
+    streams.positions.resize( count );
+    fastgltf::copyFromAccessor< glm::vec3 >( asset, positionAccessor, std::data( streams.positions ), adapter );
+
+    const bool hasNormals{ copyAttribute( asset, primitive, "NORMAL", count, streams.normals, adapter ) };
+    const bool hasUVs{ copyAttribute( asset, primitive, "TEXCOORD_0", count, streams.uvs, adapter ) };
+    const bool hasTangents{ copyAttribute( asset, primitive, "TANGENT", count, streams.tangents, adapter ) };
+
+    bool hasColors{ copyAttribute( asset, primitive, "COLOR_0", count, streams.colors, adapter ) };
+    if ( !hasColors && copyAttribute( asset, primitive, "COLOR_0", count, streams.rgbColors, adapter ) ) {
+        streams.colors.resize( count );
+        std::ranges::transform( std::span{ streams.rgbColors }.first( count ), std::begin( streams.colors ),
+                                []( const glm::vec3 color ) { return glm::vec4{ color, 1.0F }; } );
+        hasColors = true;
     }
-}
 
-void Loader::loadTextureCoord( const size_t initialIndex, std::vector< ve::Vertex >& vertices,
-                               const fastgltf::Asset& asset, const fastgltf::Primitive& primitive ) {
-    const auto uv{ primitive.findAttribute( "TEXCOORD_0" ) };
-    if ( uv != std::end( primitive.attributes ) ) {
-        const auto accessorUVIndex{ ( *uv ).accessorIndex };
-        const auto& uvAccessor{ asset.accessors.at( accessorUVIndex ) };
-        fastgltf::iterateAccessorWithIndex< glm::vec2 >(
-            asset, uvAccessor, [ &initialIndex, &vertices ]( const glm::vec2 uv, const size_t index ) {
-                vertices.at( initialIndex + index ).uv_x = uv.x;
-                vertices.at( initialIndex + index ).uv_y = uv.y;
-            } );
-    }
-}
-
-void Loader::loadColor( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                        const fastgltf::Primitive& primitive ) {
-    const auto colors{ primitive.findAttribute( "COLOR_0" ) };
-    if ( colors != std::end( primitive.attributes ) ) {
-        const auto accessorColorIndex{ ( *colors ).accessorIndex };
-        const auto& colorAccessor{ asset.accessors.at( accessorColorIndex ) };
-        fastgltf::iterateAccessorWithIndex< glm::vec4 >(
-            asset, colorAccessor, [ &initialIndex, &vertices ]( const glm::vec4 color, const size_t index ) {
-                vertices.at( initialIndex + index ).color = color;
-            } );
-    }
-}
+    vertices.resize( initialIndex + count );
+    ve::Vertex *destination{ std::data( vertices ) + initialIndex };
+    for ( size_t index{ 0U }; index < count; index++ ) {
+        ve::Vertex vertex{};
+        vertex.position = streams.positions[ index ];
+        if ( hasNormals )
+            vertex.normal = streams.normals[ index ];
+        if ( hasUVs ) {
+            vertex.uv_x = streams.uvs[ index ].x;
+            vertex.uv_y = streams.uvs[ index ].y;
+        }
+        if ( hasColors )
+            vertex.color = streams.colors[ index ];
+        if ( hasTangents )
+            vertex.tangent = streams.tangents[ index ];
 
-void Loader::loadTangent( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                          const fastgltf::Primitive& primitive ) {
-    const auto tangent{ primitive.findAttribute( "TANGENT" ) };
-    if ( tangent != std::end( primitive.attributes ) ) {
-        const auto accessorTangentIndex{ ( *tangent ).accessorIndex };
-        const auto& tagentAccessor{ asset.accessors.at( accessorTangentIndex ) };
-        fastgltf::iterateAccessorWithIndex< glm::vec4 >(
-            asset, tagentAccessor, [ &initialIndex, &vertices ]( const glm::vec4 tangent, const size_t index ) {
-                vertices.at( initialIndex + index ).tangent = tangent;
-            } );
+        destination[ index ] = vertex;
     }
 }
 
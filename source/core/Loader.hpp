@@ -1,13 +1,25 @@
 #pragma once
 
+#include "MappedFile.hpp"
 #include "Node.hpp"
+#include "SceneCache.hpp"
+#include "TextureProcessing.hpp"
+#include "UploadBatch.hpp"
 
 #include "utils/NonCopyable.hpp"
 #include "utils/NonMovable.hpp"
+#include "utils/ThreadPool.hpp"
 
 #include <fastgltf/core.hpp>
+#include <glm/vec2.hpp>
 
+#include <chrono>
+#include <deque>
 #include <filesystem>
+#include <future>
+#include <map>
+#include <mutex>
+#include <span>
 
 namespace ve {
 class Engine;
@@ -25,41 +37,132 @@ class Loader : public utils::NonCopyable,
 public:
     Loader( ve::Engine& engine, const ve::MemoryAllocator& allocator );
 
-    std::optional< std::shared_ptr< ve::gltf::Scene > > load( const std::filesystem::path& path );
+    // Returns an empty scene at once. It is cooked on a background thread and filled in by update(): geometry
+    // first, with every surface on the default material, then textures within a per-frame upload budget.
+    // Textures start with their mip tail only, finer levels follow the screen coverage of the rendered surfaces.
+    std::shared_ptr< ve::gltf::Scene > load( const std::filesystem::path& path );
+    // Publishes finished background work and updates texture residency, called on the render thread once per frame
+    // before the scenes are rendered.
+    void update();
 
 private:
-    using Constants    = ve::gltf::MetalicRoughness::Constants;
-    using Resources    = ve::gltf::MetalicRoughness::Resources;
-    using MaterialsOpt = std::optional< std::vector< ve::gltf::Material * > >;
+    using Constants  = ve::gltf::MetalicRoughness::Constants;
+    using Resources  = ve::gltf::MetalicRoughness::Resources;
+    using SurfaceRef = std::pair< ve::MeshAsset *, size_t >;
 
-    fastgltf::Parser m_parser{};
+    struct DecodedImage {
+        std::shared_ptr< const void > storage{};
+        std::span< const std::byte > texels{};
+        vk::Extent2D extent{};
+        vk::Format format{ vk::Format::eUndefined }; // eUndefined for stb output, RGBA8 in the format of its usage
+        uint32_t mipLevels{ 1U };
+    };
+
+    using ImageKey = std::pair< size_t, ve::texture::Usage >;
+
+    // glTF asset whose buffers point into memory mapped files, which live as long as the asset
+    struct MappedAsset {
+        std::optional< fastgltf::MappedGltfFile > file;
+        std::vector< std::unique_ptr< ve::MappedFile > > buffers;
+        fastgltf::Asset asset;
+    };
+
+    // scratch buffers for vertex assembly, reused between primitives
+    struct AttributeStreams {
+        std::vector< glm::vec3 > positions;
+        std::vector< glm::vec3 > normals;
+        std::vector< glm::vec2 > uvs;
+        std::vector< glm::vec4 > colors;
+        std::vector< glm::vec3 > rgbColors;
+        std::vector< glm::vec4 > tangents;
+    };
+
+    // a scene being streamed in, kept after loading while its textures are streamed by screen coverage
+    struct PendingScene {
+        std::shared_ptr< ve::gltf::Scene > scene;
+        std::future< std::optional< CookedScene > > cooking;
+        std::optional< CookedScene > cooked; // texels stay for mip streaming, geometry is dropped once uploaded
+        std::vector< std::vector< SurfaceRef > > materialSurfaces; // surfaces drawn with each material
+        std::vector< vk::DescriptorSet > materialSets;             // null until the material is resolved
+        std::vector< ve::ScreenCoverage > materialCoverage;
+        std::vector< uint64_t > lastSeenFrames; // per texture
+        std::deque< std::pair< uint64_t, ve::Image > > retiredImages;
+        std::deque< std::pair< uint64_t, vk::DescriptorSet > > retiredSets;
+        std::vector< vk::DescriptorSet > freeSets;
+        size_t nextImage{};
+        bool isLoaded{ false };
+        std::chrono::high_resolution_clock::time_point loadingStart;
+    };
+
+    fastgltf::Parser m_parser{ fastgltf::Extensions::KHR_texture_basisu |
+                               fastgltf::Extensions::EXT_mesh_gpu_instancing |
+                               fastgltf::Extensions::KHR_mesh_quantization |
+                               fastgltf::Extensions::EXT_meshopt_compression };
     ve::Engine& m_engine;
     const ve::MemoryAllocator& m_memoryAllocator;
+    ve::utils::ThreadPool m_threadPool{};
+    std::vector< DecodedImage > m_decodedImages;
+    std::vector< std::vector< std::byte > > m_decodedViews; // EXT_meshopt_compression views, empty if uncompressed
+    std::vector< size_t > m_imageAliases;
+    std::map< ImageKey, int32_t > m_imageCache;
+    std::vector< ve::texture::Usage > m_imageUsages;
+    ve::UploadBatch m_uploadBatch; // texture steps are skipped while its last submission executes
+    AttributeStreams m_attributeStreams;
+    bool m_isBlockCompressionEnabled{ false };
+    uint64_t m_frameIndex{};
+    std::mutex m_cookingMutex;
+    std::vector< PendingScene > m_pendingScenes;
+
+    // glTF import or scene cache read, producing the cooked scene on a background thread
+    std::optional< CookedScene > prepare( const std::filesystem::path& path );
+    std::optional< MappedAsset > getAsset( const std::filesystem::path& path );
+    static bool mapExternalBuffers( MappedAsset& mappedAsset, const std::filesystem::path& directory );
+    bool decodeBufferViews( const fastgltf::Asset& asset );
+    std::optional< CookedScene > cook( const std::filesystem::path& path );
+    std::vector< DecodedImage > decodeImages( const fastgltf::Asset& asset, const std::filesystem::path& directory );
+    static std::span< const std::byte > getImageBytes( const fastgltf::Asset& asset, const fastgltf::Image& image );
+    static std::string getImageSourceKey( const fastgltf::Asset& asset, const fastgltf::Image& image,
+                                          const std::filesystem::path& directory );
+    static DecodedImage decodeImage( const fastgltf::Asset& asset, const fastgltf::Image& image,
+                                     const std::filesystem::path& directory );
+    static DecodedImage decodeImage( std::span< const std::byte > bytes );
+    int32_t cookImage( CookedScene& cooked, const size_t imageIndex, const ve::texture::Usage usage );
+    void cookTextures( CookedScene& cooked );
+    bool supportsBlockCompression() const;
+    bool supportsFormat( const vk::Format format ) const;
+    static uint32_t getMipLevelsCount( const CookedImage& image ) noexcept;
+    uint32_t getCacheOptions() const noexcept;
+    void cookMaterials( const fastgltf::Asset& asset, CookedScene& cooked );
+    void cookMeshes( const fastgltf::Asset& asset, CookedScene& cooked );
+    void cookNodes( const fastgltf::Asset& asset, CookedScene& cooked );
+    void cookInstances( const fastgltf::Asset& asset, const fastgltf::Node& node, CookedScene& cooked,
+                        CookedNode& cookedNode ) const;
+    static void packVertices( CookedScene& cooked );
+    static void narrowIndices( CookedScene& cooked );
 
-    std::optional< fastgltf::Asset > getAsset( const std::filesystem::path& path );
-    std::optional< ve::Image > loadImage( const fastgltf::Asset& asset, ve::gltf::Scene& scene,
-                                          const fastgltf::Image& image, const vk::Format textureFormat );
-    MaterialsOpt loadMeterials( const fastgltf::Asset& asset, ve::gltf::Scene& scene );
-    std::vector< ve::MeshAsset * > loadMeshes( const fastgltf::Asset& asset, ve::gltf::Scene& scene );
-    std::vector< std::shared_ptr< ve::Node > > loadNodes( const fastgltf::Asset& asset, ve::gltf::Scene& scene );
-    void setNodesRalationship( const fastgltf::Asset& asset, ve::gltf::Scene& scene );
+    // GPU scene creation from the cooked scene, on the render thread; stream() returns true once nothing is left
+    bool stream( PendingScene& pending );
+    void instantiateGeometry( PendingScene& pending );
+    void streamImages( PendingScene& pending );
+    void resolveMaterials( PendingScene& pending );
+    void writeSceneMaterial( PendingScene& pending, const size_t index );
+    void updateResidency( PendingScene& pending );
+    void releaseRetired( PendingScene& pending );
+    static void computeImageCacheStats( const CookedScene& cooked, ve::gltf::Scene& scene );
+    static vk::DeviceSize getResidentSize( const ve::gltf::Scene& scene, const bool isFullyResident );
+    static std::optional< ve::Image > loadImage( ve::UploadBatch& uploadBatch, ve::StreamingTexture& texture,
+                                                 const uint32_t firstLevel );
+    void loadMaterialConstants( const CookedScene& cooked, ve::gltf::Scene& scene );
+    void loadMeshes( PendingScene& pending );
+    void loadNodes( const CookedScene& cooked, ve::gltf::Scene& scene );
 
-    Constants loadConstanst( const fastgltf::Material& material );
-    Resources loadResources( const size_t index, ve::gltf::Scene& scene, const fastgltf::Asset& asset,
-                             const fastgltf::Material& material );
+    Constants loadConstanst( const CookedMaterial& material );
+    Resources loadResources( const size_t index, ve::gltf::Scene& scene, const CookedMaterial& material );
 
-    void loadIndices( const size_t initialIndex, std::vector< uint32_t >& indices, const fastgltf::Asset& asset,
+    void loadIndices( std::vector< uint32_t >& indices, const fastgltf::Asset& asset,
                       const fastgltf::Primitive& primitive );
     void loadVertices( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
                        const fastgltf::Primitive& primitive );
-    void loadNormals( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                      const fastgltf::Primitive& primitive );
-    void loadTextureCoord( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                           const fastgltf::Primitive& primitive );
-    void loadColor( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                    const fastgltf::Primitive& primitive );
-    void loadTangent( const size_t initialIndex, std::vector< ve::Vertex >& vertices, const fastgltf::Asset& asset,
-                      const fastgltf::Primitive& primitive );
 };
 
 } // namespace ve::gltf
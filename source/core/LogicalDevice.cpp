@@ -43,6 +43,9 @@ void LogicalDevice::createLogicalDevice() {
     deviceFeatures.samplerAnisotropy = vk::True;
     deviceFeatures.sampleRateShading = vk::True;
 
+    m_isBlockCompressionEnabled         = m_physicalDevice.get().getFeatures().textureCompressionBC == vk::True;
+    deviceFeatures.textureCompressionBC = m_isBlockCompressionEnabled ? vk::True : vk::False;
+
     vk::PhysicalDeviceVulkan12Features featuresV12;
     featuresV12.sType               = vk::StructureType::ePhysicalDeviceVulkan12Features;
     featuresV12.bufferDeviceAddress = vk::True;
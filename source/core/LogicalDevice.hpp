@@ -17,11 +17,13 @@ public:
     [[nodiscard]] ve::QueueFamilyMap getQueueFamilyIDs() const noexcept { return m_physicalDevice.getQueueFamilyIDs(); }
 
     const ve::PhysicalDevice& getParentPhysicalDevice() const noexcept { return m_physicalDevice; }
+    bool isBlockCompressionEnabled() const noexcept { return m_isBlockCompressionEnabled; }
 
 private:
     std::unordered_map< ve::QueueType, vk::Queue > m_queues;
     vk::Device m_logicalDevice;
     const ve::PhysicalDevice& m_physicalDevice;
+    bool m_isBlockCompressionEnabled{ false };
 
     void createLogicalDevice();
 };
@@ -0,0 +1,88 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <format>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ve {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile( const std::filesystem::path& path ) {
+    m_file = CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( m_file == INVALID_HANDLE_VALUE )
+        throw std::runtime_error( std::format( "failed to open file: {}", path.string() ) );
+
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx( m_file, &fileSize );
+    m_size = static_cast< size_t >( fileSize.QuadPart );
+    if ( m_size == 0U )
+        return;
+
+    m_mapping = CreateFileMappingW( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( m_mapping == nullptr ) {
+        CloseHandle( m_file );
+        throw std::runtime_error( std::format( "failed to map file: {}", path.string() ) );
+    }
+
+    m_data = static_cast< const std::byte * >( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if ( m_data == nullptr ) {
+        CloseHandle( m_mapping );
+        CloseHandle( m_file );
+        throw std::runtime_error( std::format( "failed to map file: {}", path.string() ) );
+    }
+}
+
+MappedFile::~MappedFile() {
+    if ( m_data != nullptr )
+        UnmapViewOfFile( m_data );
+    if ( m_mapping != nullptr )
+        CloseHandle( m_mapping );
+    if ( m_file != INVALID_HANDLE_VALUE && m_file != nullptr )
+        CloseHandle( m_file );
+}
+
+#else
+
+MappedFile::MappedFile( const std::filesystem::path& path ) {
+    m_fileDescriptor = open( path.c_str(), O_RDONLY );
+    if ( m_fileDescriptor == -1 )
+        throw std::runtime_error( std::format( "failed to open file: {}", path.string() ) );
+
+    struct stat fileStatus{};
+    fstat( m_fileDescriptor, &fileStatus );
+    m_size = static_cast< size_t >( fileStatus.st_size );
+    if ( m_size == 0U )
+        return;
+
+    void *mapping{ mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0 ) };
+    if ( mapping == MAP_FAILED ) {
+        close( m_fileDescriptor );
+        throw std::runtime_error( std::format( "failed to map file: {}", path.string() ) );
+    }
+
+    madvise( mapping, m_size, MADV_SEQUENTIAL );
+    m_data = static_cast< const std::byte * >( mapping );
+}
+
+MappedFile::~MappedFile() {
+    if ( m_data != nullptr )
+        munmap( const_cast< std::byte * >( m_data ), m_size );
+    if ( m_fileDescriptor != -1 )
+        close( m_fileDescriptor );
+}
+
+#endif
+
+} // namespace ve
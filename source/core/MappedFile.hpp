@@ -0,0 +1,34 @@
+#pragma once
+
+#include "utils/NonCopyable.hpp"
+#include "utils/NonMovable.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace ve {
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error when the file cannot be mapped.
+class MappedFile : public utils::NonCopyable,
+                   public utils::NonMovable {
+public:
+    explicit MappedFile( const std::filesystem::path& path );
+    ~MappedFile();
+
+    std::span< const std::byte > get() const noexcept { return { m_data, m_size }; }
+    size_t size() const noexcept { return m_size; }
+
+private:
+    const std::byte *m_data{ nullptr };
+    size_t m_size{};
+
+#ifdef _WIN32
+    void *m_file{ nullptr };
+    void *m_mapping{ nullptr };
+#else
+    int m_fileDescriptor{ -1 };
+#endif
+};
+
+} // namespace ve
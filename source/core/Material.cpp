@@ -33,24 +33,45 @@ void MetalicRoughness::buildPipelines( const ve::DescriptorSetLayout& layout ) {
     meshLayoutInfo.setLayoutCount         = utils::size( layoutsVk );
     pipelineLayout.emplace( m_logicalDevice, meshLayoutInfo );
 
+    // constant_id 0 in Mesh.vert selects the vertex layout the loader produces
+    static constexpr vk::Bool32 packedVertices{ cfg::geometry::packedVertices ? vk::True : vk::False };
+    static constexpr vk::SpecializationMapEntry packedVerticesEntry{ 0U, 0U, sizeof( vk::Bool32 ) };
+    const vk::SpecializationInfo specializationInfo{ 1U, &packedVerticesEntry, sizeof( vk::Bool32 ),
+                                                     &packedVertices };
+
+    // constant_id 1 in Mesh.frag discards fragments below the alpha cutoff
+    static constexpr std::array< vk::Bool32, 2U > alphaTest{ vk::False, vk::True };
+    static constexpr vk::SpecializationMapEntry alphaTestEntry{ 1U, 0U, sizeof( vk::Bool32 ) };
+    const vk::SpecializationInfo noAlphaTestInfo{ 1U, &alphaTestEntry, sizeof( vk::Bool32 ), &alphaTest[ 0 ] };
+    const vk::SpecializationInfo alphaTestInfo{ 1U, &alphaTestEntry, sizeof( vk::Bool32 ), &alphaTest[ 1 ] };
+
     ve::PipelineBuilder builder{ m_logicalDevice };
     builder.setCullingMode( vk::CullModeFlagBits::eBack );
     builder.setShaders( meshVertexShader, meshFragmentShader );
+    builder.setVertexSpecialization( specializationInfo );
+    builder.setFragmentSpecialization( noAlphaTestInfo );
     builder.setLayout( pipelineLayout.value() );
     builder.disableBlending();
     opaquePipeline.emplace( builder );
 
-    builder.enableBlendingAdditive();
+    builder.setFragmentSpecialization( alphaTestInfo );
+    maskedPipeline.emplace( builder );
+
+    builder.setFragmentSpecialization( noAlphaTestInfo );
+    builder.enableBlendingAlpha();
     builder.disableDepthWrite();
     transparentPipeline.emplace( builder );
 }
 
 ve::Material MetalicRoughness::writeMaterial( const ve::Material::Type materialType, const Resources& resources,
                                               ve::DescriptorAllocator& descriptorAllocator ) {
-    if ( !transparentPipeline.has_value() || !opaquePipeline.has_value() )
-        throw std::runtime_error( "MetalicRoughness: pipeline not built" );
+    return writeMaterial( materialType, resources, descriptorAllocator.allocate( desMaterialLayout.value() ) );
+}
 
-    const vk::DescriptorSet set{ descriptorAllocator.allocate( desMaterialLayout.value() ) };
+ve::Material MetalicRoughness::writeMaterial( const ve::Material::Type materialType, const Resources& resources,
+                                              const vk::DescriptorSet set ) {
+    if ( !transparentPipeline.has_value() || !maskedPipeline.has_value() || !opaquePipeline.has_value() )
+        throw std::runtime_error( "MetalicRoughness: pipeline not built" );
 
     descriptorWriter.clear();
     descriptorWriter.writeBuffer( 0U, resources.dataBuffer, sizeof( Constants ), resources.dataBufferOffset,
@@ -66,6 +87,9 @@ ve::Material MetalicRoughness::writeMaterial( const ve::Material::Type materialT
     if ( materialType == ve::Material::Type::eTransparent )
         return ve::Material{ .pipeline{ transparentPipeline.value() }, .descriptorSet{ set }, .type{ materialType } };
 
+    if ( materialType == ve::Material::Type::eMasked )
+        return ve::Material{ .pipeline{ maskedPipeline.value() }, .descriptorSet{ set }, .type{ materialType } };
+
     if ( materialType == ve::Material::Type::eMainColor )
         return ve::Material{ .pipeline{ opaquePipeline.value() }, .descriptorSet{ set }, .type{ materialType } };
 
@@ -13,7 +13,8 @@ class DescriptorAllocator;
 class RenderPass;
 
 struct Material {
-    enum class Type { eMainColor, eTransparent, eOther };
+    // in draw order, masked surfaces are alpha tested after the opaque ones to keep early depth tests for those
+    enum class Type { eMainColor, eMasked, eTransparent, eOther };
 
     const ve::Pipeline& pipeline;
     vk::DescriptorSet descriptorSet;
@@ -35,7 +36,8 @@ struct MetalicRoughness {
     struct Constants {
         glm::vec4 colorFactors{};
         glm::vec4 metalicRoughnessFactors{};
-        glm::vec4 extraPadding[ 14 ];
+        glm::vec4 alphaFactors{}; // x is the alpha cutoff of masked materials
+        glm::vec4 extraPadding[ 13 ];
     };
 
     struct Resources {
@@ -52,9 +54,13 @@ struct MetalicRoughness {
     void buildPipelines( const ve::DescriptorSetLayout& layout );
     ve::Material writeMaterial( const ve::Material::Type materialType, const Resources& resources,
                                 ve::DescriptorAllocator& descriptorAllocator );
+    // rewrites an already allocated set, which must not be in use by any frame in flight
+    ve::Material writeMaterial( const ve::Material::Type materialType, const Resources& resources,
+                                const vk::DescriptorSet set );
 
     ve::DescriptorWriter descriptorWriter;
     std::optional< ve::Pipeline > opaquePipeline;
+    std::optional< ve::Pipeline > maskedPipeline;
     std::optional< ve::Pipeline > transparentPipeline;
     std::optional< ve::PipelineLayout > pipelineLayout;
     std::optional< ve::DescriptorSetLayout > desMaterialLayout;
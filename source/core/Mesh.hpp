@@ -3,6 +3,7 @@
 #include "Buffer.hpp"
 #include "Material.hpp"
 
+#include <array>
 #include <optional>
 
 namespace ve {
@@ -11,11 +12,18 @@ struct MeshBuffers {
     std::optional< ve::VertexBuffer > vertexBuffer;
     std::optional< ve::IndexBuffer > indexBuffer;
     VkDeviceAddress vertexBufferAddress;
+    vk::DeviceSize shortIndexOffset{}; // 32-bit indices come first, 16-bit ones start here
+    std::optional< ve::VertexBuffer > instanceBuffer;
+    VkDeviceAddress instanceBufferAddress{};
 };
 
+// layout matches the push constant block in Mesh.vert
 struct PushConstants {
     glm::mat4 worldMatrix;
+    glm::vec4 positionOffset;
+    glm::vec4 positionScale;
     VkDeviceAddress vertexBufferAddress;
+    VkDeviceAddress instanceBufferAddress; // per-instance transforms, indexed by gl_InstanceIndex
 
     static constexpr vk::PushConstantRange defaultRange() {
         constexpr uint32_t offset{ 0U };
@@ -23,15 +31,51 @@ struct PushConstants {
     }
 };
 
+inline constexpr uint32_t g_maxSurfaceLods{ 4U };
+
+// Simplified index range of a surface, over the same vertices.
+struct SurfaceLod {
+    uint32_t startIndex{};
+    uint32_t count{};
+    float error{}; // largest deviation from the full surface, in mesh space
+};
+
+// Axis aligned box of a surface and the sphere around its center, in mesh space.
+struct Bounds {
+    glm::vec3 minimum{ 0.0F };
+    glm::vec3 maximum{ 0.0F };
+    glm::vec4 sphere{ 0.0F }; // center and radius
+};
+
+// Largest on-screen size, in pixels, of the surfaces drawn with a material during the last frame.
+struct ScreenCoverage {
+    float maxPixels{};
+};
+
 struct Surface {
     uint32_t startIndex{};
     uint32_t count{};
+    std::array< ve::SurfaceLod, g_maxSurfaceLods > lods{}; // ordered from the finest to the coarsest
+    uint32_t lodsCount{};
+    ve::Bounds bounds{};
     std::optional< ve::gltf::Material > material;
+    int32_t materialIndex{ -1 }; // material of the scene the surface is resolved to, -1 keeps the default one
+    ve::ScreenCoverage *coverage{ nullptr }; // texture streaming feedback, owned by the loader
 };
 
+// Meshes are sub-allocated from the scene-wide geometry buffers: vertices are addressed through
+// vertexBufferAddress (already offset to firstVertex), surfaces index the shared index buffer.
 struct MeshAsset {
     std::vector< ve::Surface > surfaces;
-    ve::MeshBuffers buffers{};
+    vk::Buffer indexBuffer{};
+    vk::DeviceSize indexBufferOffset{};
+    vk::IndexType indexType{ vk::IndexType::eUint32 };
+    VkDeviceAddress vertexBufferAddress{};
+    uint32_t firstVertex{};
+    uint32_t verticesCount{};
+    glm::vec4 positionOffset{ 0.0F }; // dequantization of packed positions
+    glm::vec4 positionScale{ 1.0F };
+    glm::vec4 boundingSphere{ 0.0F }; // center and radius in mesh space
     std::string name{};
 };
 
@@ -0,0 +1,200 @@
+#include "MeshProcessing.hpp"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// triangles may get up to 5% more cache misses in exchange for less overdraw
+constexpr float g_overdrawThreshold{ 1.05F };
+
+// simplification is driven by the triangle count, the reached error is recorded for LOD selection
+constexpr float g_maxSimplificationError{ 1.0F };
+constexpr size_t g_minLodIndices{ 3U * 8U };
+constexpr float g_minLodReduction{ 0.9F }; // a level has to drop at least 10% of the previous triangles
+
+constexpr size_t g_maxStreamStride{ 256U };
+
+} // namespace
+
+namespace ve::mesh {
+
+VertexCacheStats analyzeVertexCache( std::span< const uint32_t > indices, const size_t verticesCount ) noexcept {
+    if ( indices.empty() || verticesCount == 0U )
+        return {};
+
+    const auto statistics{ meshopt_analyzeVertexCache( std::data( indices ), std::size( indices ), verticesCount,
+                                                       g_vertexCacheSize, 0U, 0U ) };
+    return { statistics.vertices_transformed, statistics.acmr, statistics.atvr };
+}
+
+size_t optimizeSurface( std::span< uint32_t > indices, std::span< ve::Vertex > vertices, const bool reduceOverdraw ) {
+    if ( indices.empty() || vertices.empty() || std::size( indices ) % 3U != 0U )
+        return std::size( vertices );
+
+    meshopt_optimizeVertexCache( std::data( indices ), std::data( indices ), std::size( indices ),
+                                 std::size( vertices ) );
+
+    if ( reduceOverdraw ) {
+        meshopt_optimizeOverdraw( std::data( indices ), std::data( indices ), std::size( indices ),
+                                  &vertices.front().position.x, std::size( vertices ), sizeof( ve::Vertex ),
+                                  g_overdrawThreshold );
+    }
+
+    return meshopt_optimizeVertexFetch( std::data( vertices ), std::data( indices ), std::size( indices ),
+                                        std::data( vertices ), std::size( vertices ), sizeof( ve::Vertex ) );
+}
+
+std::vector< SimplifiedSurface > simplifySurface( std::span< const uint32_t > indices,
+                                                  std::span< const ve::Vertex > vertices, const size_t maxLevels ) {
+    std::vector< SimplifiedSurface > levels;
+    if ( indices.empty() || vertices.empty() || std::size( indices ) % 3U != 0U )
+        return levels;
+
+    const float *positions{ &vertices.front().position.x };
+    const float scale{ meshopt_simplifyScale( positions, std::size( vertices ), sizeof( ve::Vertex ) ) };
+
+    // every level is simplified from the full surface, so its error is measured against what it replaces
+    size_t previousCount{ std::size( indices ) };
+    for ( size_t level{ 1U }; level <= maxLevels; level++ ) {
+        const size_t targetCount{ ( std::size( indices ) >> level ) / 3U * 3U };
+        if ( targetCount < g_minLodIndices )
+            break;
+
+        SimplifiedSurface simplified{ std::vector< uint32_t >( std::size( indices ) ) };
+        float error{};
+        const size_t count{ meshopt_simplify( std::data( simplified.indices ), std::data( indices ),
+                                              std::size( indices ), positions, std::size( vertices ),
+                                              sizeof( ve::Vertex ), targetCount, g_maxSimplificationError,
+                                              meshopt_SimplifyLockBorder, &error ) };
+        if ( count == 0U || static_cast< float >( count ) > static_cast< float >( previousCount ) * g_minLodReduction )
+            break;
+
+        simplified.indices.resize( count );
+        meshopt_optimizeVertexCache( std::data( simplified.indices ), std::data( simplified.indices ), count,
+                                     std::size( vertices ) );
+        simplified.error = std::max( error * scale, levels.empty() ? 0.0F : levels.back().error );
+
+        previousCount = count;
+        levels.emplace_back( std::move( simplified ) );
+    }
+
+    return levels;
+}
+
+ve::Bounds computeBounds( std::span< const ve::Vertex > vertices ) noexcept {
+    if ( vertices.empty() )
+        return {};
+
+    glm::vec3 minimum{ vertices.front().position };
+    glm::vec3 maximum{ vertices.front().position };
+    std::ranges::for_each( vertices, [ &minimum, &maximum ]( const ve::Vertex& vertex ) {
+        minimum = glm::min( minimum, vertex.position );
+        maximum = glm::max( maximum, vertex.position );
+    } );
+
+    const glm::vec3 center{ 0.5F * ( minimum + maximum ) };
+    float radius{};
+    std::ranges::for_each( vertices, [ &center, &radius ]( const ve::Vertex& vertex ) {
+        radius = std::max( radius, glm::distance( center, vertex.position ) );
+    } );
+
+    return { .minimum{ minimum }, .maximum{ maximum }, .sphere{ center, radius } };
+}
+
+glm::vec4 computeBoundingSphere( std::span< const ve::Vertex > vertices ) noexcept {
+    return computeBounds( vertices ).sphere;
+}
+
+glm::vec4 computeBoundingSphere( const glm::vec4 sphere, std::span< const glm::mat4 > transforms ) noexcept {
+    if ( transforms.empty() )
+        return sphere;
+
+    const auto getPlacedSphere{ [ &sphere ]( const glm::mat4& transform ) {
+        return glm::vec4{ glm::vec3{ transform * glm::vec4{ glm::vec3{ sphere }, 1.0F } },
+                          sphere.w * getMaxScale( transform ) };
+    } };
+
+    glm::vec3 minimum{ std::numeric_limits< float >::max() };
+    glm::vec3 maximum{ std::numeric_limits< float >::lowest() };
+    std::ranges::for_each( transforms, [ & ]( const glm::mat4& transform ) {
+        const glm::vec4 placed{ getPlacedSphere( transform ) };
+        minimum = glm::min( minimum, glm::vec3{ placed } - placed.w );
+        maximum = glm::max( maximum, glm::vec3{ placed } + placed.w );
+    } );
+
+    const glm::vec3 center{ 0.5F * ( minimum + maximum ) };
+    float radius{};
+    std::ranges::for_each( transforms, [ & ]( const glm::mat4& transform ) {
+        const glm::vec4 placed{ getPlacedSphere( transform ) };
+        radius = std::max( radius, glm::distance( center, glm::vec3{ placed } ) + placed.w );
+    } );
+
+    return glm::vec4{ center, radius };
+}
+
+float getMaxScale( const glm::mat4& transform ) noexcept {
+    return std::max( { glm::length( glm::vec3{ transform[ 0 ] } ), glm::length( glm::vec3{ transform[ 1 ] } ),
+                       glm::length( glm::vec3{ transform[ 2 ] } ) } );
+}
+
+bool decodeStream( std::span< std::byte > destination, std::span< const std::byte > source, const size_t count,
+                   const size_t stride, const StreamEncoding encoding, const StreamFilter filter ) noexcept {
+    if ( std::size( destination ) < count * stride )
+        return false;
+
+    // layouts the decoders assert on are rejected up front
+    const bool isIndexStream{ encoding != StreamEncoding::eAttributes };
+    if ( isIndexStream && stride != sizeof( uint16_t ) && stride != sizeof( uint32_t ) )
+        return false;
+    if ( !isIndexStream && ( stride == 0U || stride > g_maxStreamStride || stride % 4U != 0U ) )
+        return false;
+    if ( encoding == StreamEncoding::eTriangles && count % 3U != 0U )
+        return false;
+
+    const bool isFilterValid{ filter == StreamFilter::eNone ||
+                              ( filter == StreamFilter::eOctahedral && ( stride == 4U || stride == 8U ) ) ||
+                              ( filter == StreamFilter::eQuaternion && stride == 8U ) ||
+                              ( filter == StreamFilter::eExponential && stride % 4U == 0U ) };
+    if ( isIndexStream ? filter != StreamFilter::eNone : !isFilterValid )
+        return false;
+
+    const auto *bytes{ reinterpret_cast< const unsigned char * >( std::data( source ) ) };
+    int result{ -1 };
+    switch ( encoding ) {
+    case StreamEncoding::eAttributes:
+        result = meshopt_decodeVertexBuffer( std::data( destination ), count, stride, bytes, std::size( source ) );
+        break;
+    case StreamEncoding::eTriangles:
+        result = meshopt_decodeIndexBuffer( std::data( destination ), count, stride, bytes, std::size( source ) );
+        break;
+    case StreamEncoding::eIndices:
+        result = meshopt_decodeIndexSequence( std::data( destination ), count, stride, bytes, std::size( source ) );
+        break;
+    }
+
+    if ( result != 0 )
+        return false;
+
+    switch ( filter ) {
+    case StreamFilter::eNone:
+        break;
+    case StreamFilter::eOctahedral:
+        meshopt_decodeFilterOct( std::data( destination ), count, stride );
+        break;
+    case StreamFilter::eQuaternion:
+        meshopt_decodeFilterQuat( std::data( destination ), count, stride );
+        break;
+    case StreamFilter::eExponential:
+        meshopt_decodeFilterExp( std::data( destination ), count, stride );
+        break;
+    }
+
+    return true;
+}
+
+} // namespace ve::mesh
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "Vertex.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ve::mesh {
+
+inline constexpr uint32_t g_vertexCacheSize{ 16U };
+
+struct VertexCacheStats {
+    uint32_t verticesTransformed{};
+    float acmr{}; // transformed vertices per triangle
+    float atvr{}; // transformed vertices per vertex
+};
+
+VertexCacheStats analyzeVertexCache( std::span< const uint32_t > indices, const size_t verticesCount ) noexcept;
+
+// Reorders the triangles for the post-transform vertex cache, optionally clusters them to reduce overdraw, and
+// then reorders the vertices by first use. Indices are relative to vertices and are rewritten in place.
+// Returns the number of referenced vertices, unreferenced ones are left at the back.
+size_t optimizeSurface( std::span< uint32_t > indices, std::span< ve::Vertex > vertices, const bool reduceOverdraw );
+
+struct SimplifiedSurface {
+    std::vector< uint32_t > indices;
+    float error{}; // largest deviation from the input, in the units of the positions
+};
+
+// Quadric-error simplification into up to maxLevels surfaces, each with about half the triangles of the previous
+// one. Stops early once the simplifier no longer reduces the surface. Borders are locked so neighbouring surfaces
+// stay watertight.
+std::vector< SimplifiedSurface > simplifySurface( std::span< const uint32_t > indices,
+                                                  std::span< const ve::Vertex > vertices, const size_t maxLevels );
+
+// Bounding box and the sphere around its center.
+ve::Bounds computeBounds( std::span< const ve::Vertex > vertices ) noexcept;
+// Sphere around the bounding box center, as center and radius.
+glm::vec4 computeBoundingSphere( std::span< const ve::Vertex > vertices ) noexcept;
+// Sphere around all copies of a bounding sphere placed by transforms.
+glm::vec4 computeBoundingSphere( const glm::vec4 sphere, std::span< const glm::mat4 > transforms ) noexcept;
+
+// largest scale factor of the basis vectors, for scaling distances conservatively
+float getMaxScale( const glm::mat4& transform ) noexcept;
+
+// EXT_meshopt_compression stream layouts and the filters applied after decoding
+enum class StreamEncoding : uint8_t { eAttributes, eTriangles, eIndices };
+enum class StreamFilter : uint8_t { eNone, eOctahedral, eQuaternion, eExponential };
+
+// Decodes count elements of stride bytes into destination, returns false for malformed streams.
+bool decodeStream( std::span< std::byte > destination, std::span< const std::byte > source, const size_t count,
+                   const size_t stride, const StreamEncoding encoding, const StreamFilter filter ) noexcept;
+
+} // namespace ve::mesh
@@ -1,57 +1,219 @@
 #include "Node.hpp"
+#include "Config.hpp"
+#include "MeshProcessing.hpp"
 
+#include "utils/Common.hpp"
+
+#include <glm/geometric.hpp>
 #include <spdlog/spdlog.h>
 
-namespace ve {
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <span>
+
+namespace {
+
+uint64_t makeSortKey( const ve::RenderObject& object, const uint32_t sceneIndex, const float depth ) noexcept {
+    // [63:62] material type, [61:54] scene, [53:38] material, [37] index type, [30:0] view depth; a non-negative
+    // float orders the same as its bits, so the nearest objects of a material come first
+    static constexpr uint64_t maxScene{ 0xFFU };
+    static constexpr uint64_t maxMaterial{ 0xFFFFU };
+
+    const auto type{ static_cast< uint64_t >( object.getMaterial().type ) & 0x3U };
+    const uint64_t scene{ std::min( uint64_t{ sceneIndex }, maxScene ) };
+    const uint64_t material{ std::min( static_cast< uint64_t >( object.surface->materialIndex + 1 ), maxMaterial ) };
+    const uint64_t indexType{ object.indexType == vk::IndexType::eUint16 ? 1U : 0U };
+
+    return type << 62U | scene << 54U | material << 38U | indexType << 37U |
+           uint64_t{ std::bit_cast< uint32_t >( std::max( depth, 0.0F ) ) };
+}
 
-void Node::render( const glm::mat4& topMatrix, RenderContext& renderContext ) {
-    std::ranges::for_each( m_children, [ & ]( auto& child ) { child->render( topMatrix, renderContext ); } );
+// transparent surfaces blend over what is behind them, so they are ordered by depth alone
+uint64_t makeBackToFrontKey( const float depth ) noexcept {
+    return uint64_t{ ~std::bit_cast< uint32_t >( std::max( depth, 0.0F ) ) };
 }
 
-void Node::refreshWorldTransform( const glm::mat4& parentMatrix ) {
-    m_worldTransform = parentMatrix * m_localTransform;
-    std::ranges::for_each( m_children, [ this ]( auto& child ) { child->refreshWorldTransform( m_worldTransform ); } );
+} // namespace
+
+namespace ve {
+
+StateChanges countStateChanges( std::span< const VisibleObject > visibleObjects ) noexcept {
+    StateChanges changes{};
+    const ve::RenderObject *previous{ nullptr };
+    for ( const auto& visibleObject : visibleObjects ) {
+        const ve::RenderObject& object{ *visibleObject.object };
+        const ve::Material& material{ object.getMaterial() };
+        const bool isFirst{ previous == nullptr };
+        if ( isFirst || &material.pipeline != &previous->getMaterial().pipeline )
+            changes.pipelines++;
+        if ( isFirst || material.descriptorSet != previous->getMaterial().descriptorSet )
+            changes.descriptorSets++;
+        if ( isFirst || object.indexBuffer != previous->indexBuffer || object.indexType != previous->indexType )
+            changes.indexBuffers++;
+
+        previous = &object;
+    }
+
+    return changes;
 }
 
-void Node::setLocalTransform( const glm::mat4& transform ) {
-    m_localTransform = transform;
+void MeshNode::createRenderObjects( const ve::MeshAsset& mesh, const glm::mat4& nodeMatrix,
+                                    std::vector< RenderObject >& renderObjects ) {
+    m_firstRenderObject  = ve::utils::size( renderObjects );
+    m_renderObjectsCount = ve::utils::size( mesh.surfaces );
+
+    std::ranges::transform( mesh.surfaces, std::back_inserter( renderObjects ),
+                            [ this, &mesh, &nodeMatrix ]( const ve::Surface& surface ) {
+                                return RenderObject{ .transform{ nodeMatrix },
+                                                     .surface{ &surface },
+                                                     .indexBuffer{ mesh.indexBuffer },
+                                                     .vertexBufferAddress{ mesh.vertexBufferAddress },
+                                                     .positionOffset{ mesh.positionOffset },
+                                                     .positionScale{ mesh.positionScale },
+                                                     .indexBufferOffset{ mesh.indexBufferOffset },
+                                                     .indexType{ mesh.indexType },
+                                                     .instanceBufferAddress{ m_instances.transformsAddress },
+                                                     .instanceCount{ m_instances.count } };
+                            } );
 }
 
-void Node::addChild( std::shared_ptr< Node > child ) {
-    m_children.emplace_back( child );
+void MeshNode::updateRenderObjects( const glm::mat4& nodeMatrix, std::span< RenderObject > renderObjects ) const {
+    std::ranges::for_each( renderObjects.subspan( m_firstRenderObject, m_renderObjectsCount ),
+                           [ &nodeMatrix ]( RenderObject& renderObject ) { renderObject.transform = nodeMatrix; } );
 }
 
-void Node::setParent( std::shared_ptr< Node > parent ) {
-    m_parent = parent;
+ve::Aabb MeshNode::getBounds( const RenderObject& renderObject ) const noexcept {
+    // instanced surfaces share the box around the sphere of all instances
+    if ( m_instances.isInstanced ) {
+        const glm::vec3 center{ m_instances.boundingSphere };
+        const glm::vec3 radius{ m_instances.boundingSphere.w };
+        return ve::transformAabb( ve::Aabb{ .minimum{ center - radius }, .maximum{ center + radius } },
+                                  renderObject.transform );
+    }
+
+    const ve::Bounds& bounds{ renderObject.surface->bounds };
+    return ve::transformAabb( ve::Aabb{ .minimum{ bounds.minimum }, .maximum{ bounds.maximum } },
+                              renderObject.transform );
 }
 
-void MeshNode::render( const glm::mat4& topMatrix, RenderContext& renderContext ) {
-    const glm::mat4 nodeMatrix{ topMatrix * m_worldTransform };
-    const auto& buffers{ m_asset.buffers };
+void MeshNode::render( std::span< const RenderObject > renderObjects, std::span< const uint32_t > visibleObjects,
+                       RenderContext& renderContext ) const {
+    if ( visibleObjects.empty() )
+        return;
+
+    // all objects of the node share its transform
+    const glm::mat4& nodeMatrix{ renderObjects[ m_firstRenderObject ].transform };
+    const glm::mat4 viewMatrix{ renderContext.viewMatrix * nodeMatrix };
+    const bool hasProjection{ renderContext.projectionScale > 0.0F };
+    for ( const uint32_t index : visibleObjects ) {
+        const RenderObject& object{ renderObjects[ index ] };
+        const ve::Surface& surface{ *object.surface };
 
-    std::ranges::for_each( m_asset.surfaces, [ &buffers, &renderContext, &nodeMatrix ]( const auto& surface ) {
-        switch ( surface.material->data.type ) {
+        // only visible surfaces ask for texture detail, sized by their own sphere so a camera inside a large mesh
+        // does not pull every material of it to the finest level
+        const glm::vec4& sphere{ m_instances.isInstanced ? m_instances.boundingSphere : surface.bounds.sphere };
+        const float pixelsPerUnit{ hasProjection ? getPixelsPerUnit( sphere, viewMatrix, renderContext )
+                                                 : std::numeric_limits< float >::max() };
+        if ( hasProjection && surface.coverage != nullptr )
+            surface.coverage->maxPixels = std::max( surface.coverage->maxPixels, 2.0F * sphere.w * pixelsPerUnit );
+
+        const auto [ firstIndex, indexCount ]{ selectLod( surface, pixelsPerUnit ) };
+        renderContext.trianglesCount += uint64_t{ indexCount / 3U } * object.instanceCount;
+        renderContext.fullDetailTrianglesCount += uint64_t{ surface.count / 3U } * object.instanceCount;
+
+        const float depth{ -( viewMatrix * glm::vec4{ glm::vec3{ sphere }, 1.0F } ).z };
+        VisibleObject visibleObject{ .object{ &object },
+                                     .firstIndex{ firstIndex },
+                                     .indexCount{ indexCount },
+                                     .sortKey{ makeSortKey( object, renderContext.sceneIndex, depth ) } };
+        switch ( object.getMaterial().type ) {
         case ve::Material::Type::eMainColor: {
-            renderContext.opaqueSurfaces.emplace_back( nodeMatrix, buffers.indexBuffer->get(), surface.material->data,
-                                                       buffers.vertexBufferAddress, surface.count, surface.startIndex );
+            renderContext.opaqueSurfaces.emplace_back( visibleObject );
+            break;
+        }
+
+        case ve::Material::Type::eMasked: {
+            renderContext.maskedSurfaces.emplace_back( visibleObject );
             break;
         }
 
         case ve::Material::Type::eTransparent: {
-            renderContext.transparentSurfaces.emplace_back( nodeMatrix, buffers.indexBuffer->get(),
-                                                            surface.material->data, buffers.vertexBufferAddress,
-                                                            surface.count, surface.startIndex );
+            visibleObject.sortKey = makeBackToFrontKey( depth );
+            renderContext.transparentSurfaces.emplace_back( visibleObject );
             break;
         }
 
         default: {
             spdlog::warn( "Material type with value {} not handled.",
-                          static_cast< int >( surface.material->data.type ) );
+                          static_cast< int >( object.getMaterial().type ) );
         }
         }
-    } );
+    }
+}
+
+void MeshNode::cullRenderObjects( std::span< const RenderObject > renderObjects,
+                                  RenderContext& renderContext ) const {
+    // surface spheres are brought to the scene root space in one pass and tested in SIMD batches; instanced surfaces
+    // share the sphere around all instances
+    const auto objects{ renderObjects.subspan( m_firstRenderObject, m_renderObjectsCount ) };
+    auto& visibleObjects{ renderContext.visibleObjects };
+    if ( objects.empty() )
+        return;
+
+    auto& visibility{ renderContext.cullingVisibility };
+    visibility.resize( std::size( objects ) );
+    if constexpr ( !cfg::geometry::frustumCulling ) {
+        std::ranges::fill( visibility, uint8_t{ 1U } );
+    } else {
+        const glm::mat4& nodeMatrix{ objects.front().transform };
+        auto& spheres{ renderContext.cullingSpheres };
+        spheres.resize( std::size( objects ) );
+        const float scale{ ve::mesh::getMaxScale( nodeMatrix ) };
+        std::ranges::transform( objects, std::begin( spheres ), [ this, &nodeMatrix, scale ]( const auto& object ) {
+            const glm::vec4 sphere{ m_instances.isInstanced ? m_instances.boundingSphere
+                                                            : object.surface->bounds.sphere };
+            return glm::vec4{ glm::vec3{ nodeMatrix * glm::vec4{ glm::vec3{ sphere }, 1.0F } }, sphere.w * scale };
+        } );
 
-    Node::render( topMatrix, renderContext );
+        ve::cullSpheres( renderContext.frustum, spheres, visibility );
+        renderContext.cullingTestsCount += std::size( spheres );
+    }
+
+    for ( uint32_t index{ 0U }; index < m_renderObjectsCount; index++ )
+        if ( visibility[ index ] != 0U )
+            visibleObjects.emplace_back( m_firstRenderObject + index );
+}
+
+float MeshNode::getPixelsPerUnit( const glm::vec4& sphere, const glm::mat4& viewMatrix,
+                                  const RenderContext& renderContext ) const {
+    // on-screen size of a mesh-space unit at the nearest point of the bounding sphere, 0 behind the camera;
+    // instanced nodes use the sphere around all instances, so the nearest instance drives the detail
+    static constexpr float minDistance{ 0.1F };
+
+    const glm::vec4 center{ viewMatrix * glm::vec4{ glm::vec3{ sphere }, 1.0F } };
+    const float scale{ ve::mesh::getMaxScale( viewMatrix ) };
+    const float radius{ sphere.w * scale };
+    const float distance{ -center.z };
+    if ( distance <= -radius )
+        return 0.0F;
+
+    return scale * m_instances.maxScale * renderContext.projectionScale / std::max( distance - radius, minDistance );
+}
+
+std::pair< uint32_t, uint32_t > MeshNode::selectLod( const ve::Surface& surface, const float pixelsPerUnit ) noexcept {
+    // the coarsest level whose deviation stays within the on-screen error threshold
+    std::pair< uint32_t, uint32_t > range{ surface.startIndex, surface.count };
+    for ( const auto& lod : std::span{ surface.lods }.first( surface.lodsCount ) ) {
+        if ( lod.error * pixelsPerUnit > cfg::geometry::lodErrorPixels )
+            break;
+
+        range = { lod.startIndex, lod.count };
+    }
+
+    return range;
 }
 
 } // namespace ve
@@ -59,7 +221,91 @@ void MeshNode::render( const glm::mat4& topMatrix, RenderContext& renderContext
 namespace ve::gltf {
 
 void Scene::render( const glm::mat4& topMatrix, ve::RenderContext& renderContext ) {
-    std::ranges::for_each( topNodes, [ & ]( auto& topNode ) { topNode->render( topMatrix, renderContext ); } );
+    renderContext.updatedTransformsCount += graph.updateWorldTransforms();
+
+    // render objects keep their transforms between frames, only the moved nodes are patched and refitted
+    const auto updateMeshNode{ [ this ]( const ve::MeshNode& meshNode ) {
+        meshNode.updateRenderObjects( placement * graph.getWorldTransform( meshNode.getNode() ), renderObjects );
+        if constexpr ( cfg::geometry::boundingVolumeHierarchy ) {
+            const uint32_t first{ meshNode.getFirstRenderObject() };
+            for ( uint32_t index{ first }; index < first + meshNode.getRenderObjectsCount(); index++ )
+                bvh.setItemBounds( index, meshNode.getBounds( renderObjects[ index ] ) );
+        }
+    } };
+
+    if ( topMatrix != placement ) {
+        placement = topMatrix;
+        std::ranges::for_each( meshNodes, updateMeshNode );
+    } else {
+        // both lists are in scene graph order
+        auto meshNode{ std::begin( meshNodes ) };
+        for ( const uint32_t node : graph.getUpdatedNodes() ) {
+            meshNode = std::lower_bound(
+                meshNode, std::end( meshNodes ), node,
+                []( const ve::MeshNode& candidate, const uint32_t value ) { return candidate.getNode() < value; } );
+            for ( ; meshNode != std::end( meshNodes ) && meshNode->getNode() == node; meshNode++ )
+                updateMeshNode( *meshNode );
+        }
+    }
+
+    if constexpr ( cfg::geometry::boundingVolumeHierarchy )
+        renderContext.refittedNodesCount += bvh.refit();
+
+    auto& visibleObjects{ renderContext.visibleObjects };
+    visibleObjects.clear();
+    if constexpr ( cfg::geometry::frustumCulling && cfg::geometry::boundingVolumeHierarchy ) {
+        renderContext.cullingTestsCount += bvh.queryFrustum( renderContext.frustum, visibleObjects );
+        // the hierarchy gives them in spatial order, the mesh nodes below take them in render object order
+        std::ranges::sort( visibleObjects );
+    } else {
+        std::ranges::for_each( meshNodes, [ this, &renderContext ]( const ve::MeshNode& meshNode ) {
+            meshNode.cullRenderObjects( renderObjects, renderContext );
+        } );
+    }
+    renderContext.visibleSurfacesCount += std::size( visibleObjects );
+    renderContext.culledSurfacesCount += std::size( renderObjects ) - std::size( visibleObjects );
+
+    // visible objects come in runs per mesh node, the nodes without any are skipped
+    auto meshNode{ std::begin( meshNodes ) };
+    for ( auto first{ std::begin( visibleObjects ) }; first != std::end( visibleObjects ); ) {
+        const auto isBefore{ [ object{ *first } ]( const ve::MeshNode& candidate ) {
+            return candidate.getFirstRenderObject() + candidate.getRenderObjectsCount() <= object;
+        } };
+        meshNode = std::partition_point( meshNode, std::end( meshNodes ), isBefore );
+        const uint32_t end{ meshNode->getFirstRenderObject() + meshNode->getRenderObjectsCount() };
+        const auto last{ std::find_if( first, std::end( visibleObjects ),
+                                       [ end ]( const uint32_t object ) { return object >= end; } ) };
+        meshNode->render( renderObjects, std::span{ first, last }, renderContext );
+        first = last;
+    }
+}
+
+void Scene::createRenderObjects() {
+    renderObjects.clear();
+    std::ranges::for_each( meshNodes, [ this ]( ve::MeshNode& meshNode ) {
+        meshNode.createRenderObjects( meshes[ meshNode.getMesh() ],
+                                      placement * graph.getWorldTransform( meshNode.getNode() ), renderObjects );
+    } );
+
+    if constexpr ( cfg::geometry::boundingVolumeHierarchy ) {
+        using namespace std::chrono;
+        const auto buildStart{ high_resolution_clock::now() };
+
+        std::vector< ve::Aabb > bounds;
+        bounds.reserve( std::size( renderObjects ) );
+        std::ranges::for_each( meshNodes, [ this, &bounds ]( const ve::MeshNode& meshNode ) {
+            const auto objects{ std::span{ renderObjects }.subspan( meshNode.getFirstRenderObject(),
+                                                                     meshNode.getRenderObjectsCount() ) };
+            std::ranges::transform( objects, std::back_inserter( bounds ), [ &meshNode ]( const auto& object ) {
+                return meshNode.getBounds( object );
+            } );
+        } );
+        bvh.build( bounds );
+
+        const duration< float, std::milli > buildTime{ high_resolution_clock::now() - buildStart };
+        spdlog::info( "BVH: {} nodes over {} surfaces, {} levels, built in {:.2f} ms", bvh.getNodesCount(),
+                      bvh.getItemsCount(), bvh.getDepth(), buildTime.count() );
+    }
 }
 
 } // namespace ve::gltf
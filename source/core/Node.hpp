@@ -1,25 +1,71 @@
 #pragma once
 
+#include "BoundingVolumeHierarchy.hpp"
+#include "Frustum.hpp"
 #include "Material.hpp"
 #include "Mesh.hpp"
 #include "Sampler.hpp"
+#include "SceneGraph.hpp"
+#include "StreamingTexture.hpp"
 
 #include "descriptor/DescriptorAllocator.hpp"
 
+#include <span>
+
 namespace ve {
 
+// Draw state of a surface at a mesh node. Built once when the scene is loaded, its transform is patched when the
+// node moves, and the material is read through the surface so swapping it needs no patching.
 struct RenderObject {
-    const glm::mat4 transform;
-    const vk::Buffer indexBuffer;
-    const ve::Material& material;
-    const vk::DeviceAddress vertexBufferAddress;
-    const uint32_t indexCount{};
-    const uint32_t firstIndex{};
+    glm::mat4 transform{ 1.0F };
+    const ve::Surface *surface{ nullptr };
+    vk::Buffer indexBuffer{};
+    vk::DeviceAddress vertexBufferAddress{};
+    glm::vec4 positionOffset{ 0.0F };
+    glm::vec4 positionScale{ 1.0F };
+    vk::DeviceSize indexBufferOffset{};
+    vk::IndexType indexType{ vk::IndexType::eUint32 };
+    vk::DeviceAddress instanceBufferAddress{};
+    uint32_t instanceCount{ 1U };
+
+    const ve::Material& getMaterial() const noexcept { return surface->material->data; }
+};
+
+// render object selected for the frame, with the index range of its level of detail
+struct VisibleObject {
+    const ve::RenderObject *object{ nullptr };
+    uint32_t firstIndex{};
+    uint32_t indexCount{};
+    uint64_t sortKey{}; // draw state then nearest first, only the view depth from the farthest for transparent draws
 };
 
+// state bound between consecutive draws of a list
+struct StateChanges {
+    uint32_t pipelines{};
+    uint32_t descriptorSets{};
+    uint32_t indexBuffers{};
+};
+
+StateChanges countStateChanges( std::span< const VisibleObject > visibleObjects ) noexcept;
+
 struct RenderContext {
-    std::vector< RenderObject > opaqueSurfaces;
-    std::vector< RenderObject > transparentSurfaces;
+    std::vector< VisibleObject > opaqueSurfaces;
+    std::vector< VisibleObject > maskedSurfaces;
+    std::vector< VisibleObject > transparentSurfaces;
+    glm::mat4 viewMatrix{ 1.0F }; // view * model of the scene root
+    float projectionScale{};      // pixels per unit at unit distance, 0 disables LODs and screen coverage feedback
+    ve::Frustum frustum{};        // in the space of the scene root, keeps everything by default
+    uint32_t sceneIndex{};        // scene being rendered, keeps the draws of each scene together
+    uint64_t trianglesCount{};
+    uint64_t fullDetailTrianglesCount{};
+    uint64_t updatedTransformsCount{};
+    uint64_t visibleSurfacesCount{};
+    uint64_t culledSurfacesCount{};
+    uint64_t cullingTestsCount{};  // bounding volumes tested against the frustum
+    uint64_t refittedNodesCount{}; // of the scene BVHs
+    std::vector< glm::vec4 > cullingSpheres; // scratch, reused between mesh nodes
+    std::vector< uint8_t > cullingVisibility;
+    std::vector< uint32_t > visibleObjects; // scratch, render objects of the scene being rendered
 };
 
 class Renderable {
@@ -28,57 +74,87 @@ public:
     virtual void render( const glm::mat4& topMatrix, RenderContext& renderContext ) = 0;
 };
 
-class Node : public Renderable {
-public:
-    virtual void render( const glm::mat4& topMatrix, RenderContext& renderContext ) override;
-    void refreshWorldTransform( const glm::mat4& parentMatrix );
-
-    void setLocalTransform( const glm::mat4& transform );
-    void addChild( std::shared_ptr< Node > child );
-    void setParent( std::shared_ptr< Node > parent );
-
-    std::weak_ptr< Node > getParent() const noexcept { return m_parent; }
-    glm::mat4& getLocalTransform() noexcept { return m_localTransform; }
-
-protected:
-    glm::mat4 m_localTransform{ 1.0F };
-    glm::mat4 m_worldTransform{ 1.0F };
-    std::vector< std::shared_ptr< Node > > m_children;
-    std::weak_ptr< Node > m_parent;
+// transforms of a node drawn with EXT_mesh_gpu_instancing, a single identity transform otherwise
+struct MeshInstances {
+    vk::DeviceAddress transformsAddress{};
+    uint32_t count{ 1U };
+    glm::vec4 boundingSphere{ 0.0F }; // union of the instanced mesh spheres, in node space
+    float maxScale{ 1.0F };           // largest scale among the instance transforms
+    bool isInstanced{ false };
 };
 
-class MeshNode : public Node {
+// mesh drawn at a scene graph node, both referenced by index
+class MeshNode {
 public:
-    MeshNode( const ve::MeshAsset& meshAsset ) : m_asset{ meshAsset } {}
-
-    virtual void render( const glm::mat4& topMatrix, RenderContext& renderContext ) override;
+    MeshNode( const uint32_t node, const uint32_t mesh, const ve::MeshInstances& instances )
+        : m_node{ node }, m_mesh{ mesh }, m_instances{ instances } {}
+
+    // appends a render object per surface, the node keeps their range
+    void createRenderObjects( const ve::MeshAsset& mesh, const glm::mat4& nodeMatrix,
+                              std::vector< RenderObject >& renderObjects );
+    void updateRenderObjects( const glm::mat4& nodeMatrix, std::span< RenderObject > renderObjects ) const;
+    // box of one of the node render objects in the space of the scene root
+    ve::Aabb getBounds( const RenderObject& renderObject ) const noexcept;
+    // appends the render objects of the node inside the frustum to renderContext.visibleObjects
+    void cullRenderObjects( std::span< const RenderObject > renderObjects, RenderContext& renderContext ) const;
+    // selects the levels of detail of the visible render objects of the node and reports their screen coverage,
+    // renderObjects is the whole list of the scene and visibleObjects index it
+    void render( std::span< const RenderObject > renderObjects, std::span< const uint32_t > visibleObjects,
+                 RenderContext& renderContext ) const;
+
+    uint32_t getNode() const noexcept { return m_node; }
+    uint32_t getMesh() const noexcept { return m_mesh; }
+    uint32_t getFirstRenderObject() const noexcept { return m_firstRenderObject; }
+    uint32_t getRenderObjectsCount() const noexcept { return m_renderObjectsCount; }
 
 private:
-    const ve::MeshAsset& m_asset;
+    uint32_t m_node{};
+    uint32_t m_mesh{};
+    ve::MeshInstances m_instances;
+    uint32_t m_firstRenderObject{};
+    uint32_t m_renderObjectsCount{};
+
+    float getPixelsPerUnit( const glm::vec4& sphere, const glm::mat4& viewMatrix,
+                            const RenderContext& renderContext ) const;
+    static std::pair< uint32_t, uint32_t > selectLod( const ve::Surface& surface, const float pixelsPerUnit ) noexcept;
 };
 
 } // namespace ve
 
 namespace ve::gltf {
 
+struct ImageCacheStats {
+    uint32_t uniqueImages{};
+    uint32_t reusedImages{};
+    vk::DeviceSize savedBytes{};
+};
+
 struct Scene : public ve::Renderable {
     ~Scene() {}
 
-    using MeshMap     = std::unordered_map< std::string, ve::MeshAsset >;
-    using NodeMap     = std::unordered_map< std::string, std::shared_ptr< ve::Node > >;
+    using NodeMap     = std::unordered_map< std::string, uint32_t >; // scene graph index by node name
     using MaterialMap = std::unordered_map< std::string, ve::gltf::Material >;
 
     virtual void render( const glm::mat4& topMatrix, ve::RenderContext& renderContext ) override;
 
-    MeshMap meshes;
+    std::vector< ve::MeshAsset > meshes; // allocated once, surfaces are referenced by pointer while streaming
     NodeMap nodes;
     MaterialMap materials;
     std::filesystem::path path;
-    std::vector< ve::Image > images;
-    std::vector< std::shared_ptr< ve::Node > > topNodes;
+    std::vector< ve::StreamingTexture > images;
+    ve::SceneGraph graph;
+    std::vector< ve::MeshNode > meshNodes; // in scene graph order
+    std::vector< ve::RenderObject > renderObjects;
+    ve::BoundingVolumeHierarchy bvh; // over the render objects, in the space of the scene root
+    glm::mat4 placement{ 1.0F }; // top matrix the render objects were built with
+
+    // retained render list, built once the meshes and nodes are loaded
+    void createRenderObjects();
     std::vector< ve::Sampler > samplers;
     std::optional< ve::DescriptorAllocator > descriptorAllocator;
     std::optional< ve::UniformBuffer > materialDataBuffer;
+    ve::MeshBuffers geometryBuffers{};
+    ve::gltf::ImageCacheStats imageCacheStats{};
 };
 
 } // namespace ve::gltf
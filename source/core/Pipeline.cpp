@@ -4,6 +4,7 @@
 #include "descriptor/DescriptorSetLayout.hpp"
 #include "utils/Common.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace ve {
@@ -112,6 +113,20 @@ void PipelineBuilder::setShaders( const ve::ShaderModule& vertexShader, const ve
     addShaderStage( vk::ShaderStageFlagBits::eFragment, fragmentShader );
 }
 
+void PipelineBuilder::setVertexSpecialization( const vk::SpecializationInfo& specializationInfo ) {
+    std::ranges::for_each( m_shaderStages, [ &specializationInfo ]( auto& shaderStage ) {
+        if ( shaderStage.stage == vk::ShaderStageFlagBits::eVertex )
+            shaderStage.pSpecializationInfo = &specializationInfo;
+    } );
+}
+
+void PipelineBuilder::setFragmentSpecialization( const vk::SpecializationInfo& specializationInfo ) {
+    std::ranges::for_each( m_shaderStages, [ &specializationInfo ]( auto& shaderStage ) {
+        if ( shaderStage.stage == vk::ShaderStageFlagBits::eFragment )
+            shaderStage.pSpecializationInfo = &specializationInfo;
+    } );
+}
+
 void PipelineBuilder::setLayout( const ve::PipelineLayout& pipelineLayout ) {
     m_pipelineLayout.emplace( pipelineLayout.get() );
 }
@@ -164,6 +179,18 @@ void PipelineBuilder::enableBlendingAdditive() noexcept {
                                                  vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
 }
 
+void PipelineBuilder::enableBlendingAlpha() noexcept {
+    m_colorBlendAttachmentState.blendEnable         = vk::True;
+    m_colorBlendAttachmentState.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+    m_colorBlendAttachmentState.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+    m_colorBlendAttachmentState.colorBlendOp        = vk::BlendOp::eAdd;
+    m_colorBlendAttachmentState.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+    m_colorBlendAttachmentState.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+    m_colorBlendAttachmentState.alphaBlendOp        = vk::BlendOp::eAdd;
+    m_colorBlendAttachmentState.colorWriteMask      = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                                 vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+}
+
 void PipelineBuilder::disableDepthWrite() noexcept {
     m_depthStencilState.depthWriteEnable = vk::False;
 }
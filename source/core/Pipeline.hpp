@@ -50,6 +50,9 @@ public:
                      const ve::ShaderModule& fragmentShader, const ve::PipelineLayout& pipelineLayout );
 
     void setShaders( const ve::ShaderModule& vertexShader, const ve::ShaderModule& fragmentShader );
+    // info must outlive every build() call
+    void setVertexSpecialization( const vk::SpecializationInfo& specializationInfo );
+    void setFragmentSpecialization( const vk::SpecializationInfo& specializationInfo );
     void setLayout( const ve::PipelineLayout& pipelineLayout );
     void setSamplesCount( const vk::SampleCountFlagBits samplesCount );
     void setSampleShading( const float minSampleShading );
@@ -61,6 +64,7 @@ public:
 
     void disableBlending() noexcept;
     void enableBlendingAdditive() noexcept;
+    void enableBlendingAlpha() noexcept;
     void disableDepthWrite() noexcept;
 
     const auto& getDepthStencilState() const noexcept { return m_depthStencilState; }
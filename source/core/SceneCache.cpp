@@ -0,0 +1,406 @@
+#include "SceneCache.hpp"
+#include "Config.hpp"
+#include "TextureProcessing.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+constexpr uint32_t g_magic{ 0x43534556U }; // "VESC"
+constexpr uint64_t g_blobAlignment{ 16U };
+constexpr uint32_t g_noFilter{ ~0U };
+
+template < typename T >
+concept Trivial = std::is_trivially_copyable_v< T >;
+
+struct Header {
+    uint32_t magic{ g_magic };
+    uint32_t version{ cfg::loader::sceneCacheVersion };
+    uint32_t vertexSize{ sizeof( ve::Vertex ) };
+    uint32_t options{};
+    uint64_t sourceSize{};
+    int64_t sourceWriteTime{};
+
+    bool operator==( const Header& ) const = default;
+};
+
+Header makeHeader( const std::filesystem::path& sourcePath, const uint32_t options ) {
+    Header header{};
+    header.options         = options;
+    header.sourceSize      = std::filesystem::file_size( sourcePath );
+    header.sourceWriteTime = std::filesystem::last_write_time( sourcePath ).time_since_epoch().count();
+    return header;
+}
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter( std::ofstream& stream ) : m_stream{ stream } {}
+
+    template < Trivial T >
+    void write( const T& value ) {
+        writeBytes( &value, sizeof( T ) );
+    }
+
+    template < Trivial T >
+    void writeArray( std::span< const T > values ) {
+        write( static_cast< uint64_t >( std::size( values ) ) );
+        align();
+        writeBytes( std::data( values ), std::size( values ) * sizeof( T ) );
+    }
+
+    void writeString( const std::string_view string ) {
+        write( static_cast< uint32_t >( std::size( string ) ) );
+        writeBytes( std::data( string ), std::size( string ) );
+    }
+
+private:
+    std::ofstream& m_stream;
+    uint64_t m_offset{};
+
+    void writeBytes( const void *data, const size_t size ) {
+        m_stream.write( static_cast< const char * >( data ), static_cast< std::streamsize >( size ) );
+        m_offset += size;
+    }
+
+    void align() {
+        static constexpr std::array< char, g_blobAlignment > padding{};
+        writeBytes( std::data( padding ), ( g_blobAlignment - m_offset % g_blobAlignment ) % g_blobAlignment );
+    }
+};
+
+class BinaryReader {
+public:
+    explicit BinaryReader( std::span< const std::byte > data ) : m_data{ data } {}
+
+    template < Trivial T >
+    T read() {
+        T value;
+        memcpy( &value, take( sizeof( T ) ), sizeof( T ) );
+        return value;
+    }
+
+    // returns a view into the mapped file, blobs are aligned when written
+    template < Trivial T >
+    std::span< const T > readArray() {
+        const auto count{ read< uint64_t >() };
+        m_offset = ( m_offset + g_blobAlignment - 1U ) & ~( g_blobAlignment - 1U );
+        if ( count > std::size( m_data ) / sizeof( T ) )
+            throw std::runtime_error( "scene cache array is out of bounds" );
+
+        const auto *data{ take( count * sizeof( T ) ) };
+        return { reinterpret_cast< const T * >( data ), static_cast< size_t >( count ) };
+    }
+
+    std::string readString() {
+        const auto size{ read< uint32_t >() };
+        const auto *data{ take( size ) };
+        return { reinterpret_cast< const char * >( data ), size };
+    }
+
+private:
+    std::span< const std::byte > m_data;
+    size_t m_offset{};
+
+    const std::byte *take( const size_t size ) {
+        if ( m_offset > std::size( m_data ) || size > std::size( m_data ) - m_offset )
+            throw std::runtime_error( "scene cache is truncated" );
+
+        const auto *data{ std::data( m_data ) + m_offset };
+        m_offset += size;
+        return data;
+    }
+};
+
+uint32_t toRaw( const std::optional< fastgltf::Filter > filter ) noexcept {
+    return filter.has_value() ? static_cast< uint32_t >( filter.value() ) : g_noFilter;
+}
+
+std::optional< fastgltf::Filter > fromRaw( const uint32_t filter ) noexcept {
+    if ( filter == g_noFilter )
+        return std::nullopt;
+    return static_cast< fastgltf::Filter >( filter );
+}
+
+void writeScene( BinaryWriter& writer, const ve::gltf::CookedScene& scene ) {
+    using namespace ve::gltf;
+
+    writer.write( static_cast< uint32_t >( std::size( scene.samplers ) ) );
+    for ( const auto& sampler : scene.samplers ) {
+        writer.write( toRaw( sampler.magFilter ) );
+        writer.write( toRaw( sampler.minFilter ) );
+    }
+
+    writer.write( static_cast< uint32_t >( std::size( scene.materials ) ) );
+    for ( const auto& material : scene.materials ) {
+        writer.writeString( material.name );
+        writer.write( material.colorFactors );
+        writer.write( material.metalicRoughnessFactors );
+        writer.write( material.type );
+        writer.write( material.alphaCutoff );
+        writer.write( material.baseColor );
+        writer.write( material.normal );
+        writer.write( material.metalicRoughness );
+    }
+
+    writer.write( static_cast< uint32_t >( std::size( scene.meshes ) ) );
+    for ( const auto& mesh : scene.meshes ) {
+        writer.writeString( mesh.name );
+        writer.write( mesh.firstSurface );
+        writer.write( mesh.surfacesCount );
+        writer.write( mesh.firstVertex );
+        writer.write( mesh.verticesCount );
+        writer.write( mesh.positionOffset );
+        writer.write( mesh.positionScale );
+        writer.write( mesh.boundingSphere );
+        writer.write( mesh.indexType );
+    }
+
+    writer.write( static_cast< uint32_t >( std::size( scene.nodes ) ) );
+    for ( const auto& node : scene.nodes ) {
+        writer.writeString( node.name );
+        writer.write( node.localTransform );
+        writer.write( node.meshIndex );
+        writer.write( node.parentIndex );
+        writer.write( node.firstInstance );
+        writer.write( node.instancesCount );
+        writer.write( node.instancesBoundingSphere );
+    }
+
+    writer.writeArray( std::span< const CookedSurface >{ scene.surfaces } );
+    writer.writeArray( scene.vertices );
+    writer.writeArray( scene.packedVertices );
+    writer.writeArray( scene.indices );
+    writer.writeArray( scene.shortIndices );
+    writer.writeArray( scene.instanceTransforms );
+
+    writer.write( static_cast< uint32_t >( std::size( scene.images ) ) );
+    for ( const auto& image : scene.images ) {
+        writer.write( image.format );
+        writer.write( image.extent );
+        writer.write( image.mipLevels );
+        writer.writeArray( image.texels );
+    }
+}
+
+bool isValidIndex( const int32_t index, const size_t count ) noexcept {
+    return index < 0 || static_cast< size_t >( index ) < count;
+}
+
+void validateScene( const ve::gltf::CookedScene& scene ) {
+    using namespace ve::gltf;
+
+    const auto isValidTexture{ [ &scene ]( const CookedTexture& texture ) {
+        return isValidIndex( texture.imageIndex, std::size( scene.images ) ) &&
+               isValidIndex( texture.samplerIndex, std::size( scene.samplers ) );
+    } };
+
+    // the type is read raw, so only the ones some pass draws are accepted
+    const auto isValidType{ []( const ve::Material::Type type ) {
+        return type == ve::Material::Type::eMainColor || type == ve::Material::Type::eMasked ||
+               type == ve::Material::Type::eTransparent;
+    } };
+
+    const bool areMaterialsValid{ std::ranges::all_of( scene.materials, [ & ]( const CookedMaterial& material ) {
+        return isValidType( material.type ) && isValidTexture( material.baseColor ) &&
+               isValidTexture( material.normal ) && isValidTexture( material.metalicRoughness );
+    } ) };
+
+    const bool areSurfacesValid{ std::ranges::all_of( scene.surfaces, [ &scene ]( const CookedSurface& surface ) {
+        return isValidIndex( surface.materialIndex, std::size( scene.materials ) );
+    } ) };
+
+    // surfaces index the 16-bit or the 32-bit array, depending on their mesh
+    const size_t verticesCount{ std::max( std::size( scene.vertices ), std::size( scene.packedVertices ) ) };
+    const bool areMeshesValid{ std::ranges::all_of( scene.meshes, [ &scene, verticesCount ]( const CookedMesh& mesh ) {
+        const bool isIndexTypeValid{ mesh.indexType == vk::IndexType::eUint16 ||
+                                     mesh.indexType == vk::IndexType::eUint32 };
+        if ( !isIndexTypeValid || uint64_t{ mesh.firstSurface } + mesh.surfacesCount > std::size( scene.surfaces ) ||
+             uint64_t{ mesh.firstVertex } + mesh.verticesCount > verticesCount )
+            return false;
+
+        // index values are relative to the first vertex of the mesh and are followed on the GPU unchecked
+        const bool isShort{ mesh.indexType == vk::IndexType::eUint16 };
+        const size_t indicesCount{ isShort ? std::size( scene.shortIndices ) : std::size( scene.indices ) };
+        const auto isValidRange{ [ &scene, &mesh, isShort, indicesCount ]( const uint32_t startIndex,
+                                                                          const uint32_t count ) {
+            if ( uint64_t{ startIndex } + count > indicesCount )
+                return false;
+
+            const auto isValidVertex{ [ &mesh ]( const uint32_t index ) { return index < mesh.verticesCount; } };
+            return isShort ? std::ranges::all_of( std::span{ scene.shortIndices }.subspan( startIndex, count ),
+                                                  isValidVertex )
+                           : std::ranges::all_of( std::span{ scene.indices }.subspan( startIndex, count ),
+                                                  isValidVertex );
+        } };
+        const auto surfaces{ std::span{ scene.surfaces }.subspan( mesh.firstSurface, mesh.surfacesCount ) };
+        return std::ranges::all_of( surfaces, [ &isValidRange ]( const CookedSurface& surface ) {
+            if ( surface.lodsCount > ve::g_maxSurfaceLods || !isValidRange( surface.startIndex, surface.count ) )
+                return false;
+
+            const auto lods{ std::span{ surface.lods }.first( surface.lodsCount ) };
+            return std::ranges::all_of( lods, [ &isValidRange ]( const ve::SurfaceLod& lod ) {
+                return isValidRange( lod.startIndex, lod.count );
+            } );
+        } );
+    } ) };
+
+    const bool areNodesValid{ std::ranges::all_of( scene.nodes, [ &scene ]( const CookedNode& node ) {
+        return isValidIndex( node.meshIndex, std::size( scene.meshes ) ) &&
+               isValidIndex( node.parentIndex, std::size( scene.nodes ) ) &&
+               uint64_t{ node.firstInstance } + node.instancesCount <= std::size( scene.instanceTransforms );
+    } ) };
+
+    // only the formats cooking or KTX2 files produce, anything else would be passed to the image as is
+    const bool areImagesValid{ std::ranges::all_of( scene.images, []( const CookedImage& image ) {
+        const bool isValidFormat{ image.format == vk::Format::eR8G8B8A8Srgb ||
+                                  image.format == vk::Format::eR8G8B8A8Unorm ||
+                                  ve::texture::isBlockCompressed( image.format ) };
+        if ( !isValidFormat || image.extent.width == 0U || image.extent.height == 0U || image.mipLevels == 0U )
+            return false;
+
+        const auto chainSize{ ve::texture::getMipChainSize( image.format, image.extent, image.mipLevels ) };
+        return image.mipLevels <= ve::texture::getMipLevelsCount( image.extent ) &&
+               std::size( image.texels ) >= chainSize;
+    } ) };
+
+    if ( !areMaterialsValid || !areSurfacesValid || !areMeshesValid || !areNodesValid || !areImagesValid )
+        throw std::runtime_error( "scene cache references are out of range" );
+}
+
+ve::gltf::CookedScene readScene( BinaryReader& reader ) {
+    using namespace ve::gltf;
+    CookedScene scene;
+
+    scene.samplers.resize( reader.read< uint32_t >() );
+    for ( auto& sampler : scene.samplers ) {
+        sampler.magFilter = fromRaw( reader.read< uint32_t >() );
+        sampler.minFilter = fromRaw( reader.read< uint32_t >() );
+    }
+
+    scene.materials.resize( reader.read< uint32_t >() );
+    for ( auto& material : scene.materials ) {
+        material.name                    = reader.readString();
+        material.colorFactors            = reader.read< glm::vec4 >();
+        material.metalicRoughnessFactors = reader.read< glm::vec4 >();
+        material.type                    = reader.read< ve::Material::Type >();
+        material.alphaCutoff             = reader.read< float >();
+        material.baseColor               = reader.read< CookedTexture >();
+        material.normal                  = reader.read< CookedTexture >();
+        material.metalicRoughness        = reader.read< CookedTexture >();
+    }
+
+    scene.meshes.resize( reader.read< uint32_t >() );
+    for ( auto& mesh : scene.meshes ) {
+        mesh.name           = reader.readString();
+        mesh.firstSurface   = reader.read< uint32_t >();
+        mesh.surfacesCount  = reader.read< uint32_t >();
+        mesh.firstVertex    = reader.read< uint32_t >();
+        mesh.verticesCount  = reader.read< uint32_t >();
+        mesh.positionOffset = reader.read< glm::vec4 >();
+        mesh.positionScale  = reader.read< glm::vec4 >();
+        mesh.boundingSphere = reader.read< glm::vec4 >();
+        mesh.indexType      = reader.read< vk::IndexType >();
+    }
+
+    scene.nodes.resize( reader.read< uint32_t >() );
+    for ( auto& node : scene.nodes ) {
+        node.name                    = reader.readString();
+        node.localTransform          = reader.read< glm::mat4 >();
+        node.meshIndex               = reader.read< int32_t >();
+        node.parentIndex             = reader.read< int32_t >();
+        node.firstInstance           = reader.read< uint32_t >();
+        node.instancesCount          = reader.read< uint32_t >();
+        node.instancesBoundingSphere = reader.read< glm::vec4 >();
+    }
+
+    const auto surfaces{ reader.readArray< CookedSurface >() };
+    scene.surfaces.assign( std::begin( surfaces ), std::end( surfaces ) );
+    scene.vertices           = reader.readArray< ve::Vertex >();
+    scene.packedVertices     = reader.readArray< ve::PackedVertex >();
+    scene.indices            = reader.readArray< uint32_t >();
+    scene.shortIndices       = reader.readArray< uint16_t >();
+    scene.instanceTransforms = reader.readArray< glm::mat4 >();
+
+    scene.images.resize( reader.read< uint32_t >() );
+    for ( auto& image : scene.images ) {
+        image.format    = reader.read< vk::Format >();
+        image.extent    = reader.read< vk::Extent2D >();
+        image.mipLevels = reader.read< uint32_t >();
+        image.texels    = reader.readArray< std::byte >();
+    }
+
+    validateScene( scene );
+    return scene;
+}
+
+} // namespace
+
+namespace ve::gltf::cache {
+
+std::filesystem::path getCachePath( const std::filesystem::path& sourcePath ) {
+    const auto sourceKey{ std::filesystem::absolute( sourcePath ).lexically_normal().string() };
+    return cfg::directory::sceneCache / std::format( "{}-{:016x}.vecache", sourcePath.stem().string(),
+                                                     std::hash< std::string >{}( sourceKey ) );
+}
+
+std::optional< CookedScene > read( const std::filesystem::path& cachePath, const std::filesystem::path& sourcePath,
+                                   const uint32_t options ) {
+    std::error_code error;
+    if ( !std::filesystem::exists( cachePath, error ) )
+        return std::nullopt;
+
+    try {
+        auto mapping{ std::make_shared< const ve::MappedFile >( cachePath ) };
+        BinaryReader reader{ mapping->get() };
+
+        if ( reader.read< Header >() != makeHeader( sourcePath, options ) ) {
+            spdlog::info( "Scene cache is outdated: {}", cachePath.string() );
+            return std::nullopt;
+        }
+
+        auto scene{ readScene( reader ) };
+        scene.mapping = std::move( mapping );
+        return scene;
+    } catch ( const std::exception& exception ) {
+        spdlog::warn( "Failed to read scene cache {}: {}", cachePath.string(), exception.what() );
+    }
+
+    return std::nullopt;
+}
+
+bool write( const std::filesystem::path& cachePath, const std::filesystem::path& sourcePath, const uint32_t options,
+            const CookedScene& scene ) {
+    auto temporaryPath{ cachePath };
+    temporaryPath += ".tmp";
+
+    try {
+        std::filesystem::create_directories( cachePath.parent_path() );
+        {
+            std::ofstream stream{ temporaryPath, std::ios::binary | std::ios::trunc };
+            stream.exceptions( std::ios::failbit | std::ios::badbit );
+
+            BinaryWriter writer{ stream };
+            writer.write( makeHeader( sourcePath, options ) );
+            writeScene( writer, scene );
+        }
+        std::filesystem::rename( temporaryPath, cachePath );
+    } catch ( const std::exception& exception ) {
+        spdlog::warn( "Failed to write scene cache {}: {}", cachePath.string(), exception.what() );
+        std::error_code error;
+        std::filesystem::remove( temporaryPath, error );
+        return false;
+    }
+
+    spdlog::info( "Written scene cache: {}", cachePath.string() );
+    return true;
+}
+
+} // namespace ve::gltf::cache
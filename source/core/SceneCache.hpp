@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include "Material.hpp"
+#include "Mesh.hpp"
+#include "MappedFile.hpp"
+
+#include <fastgltf/types.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ve::gltf {
+
+// Engine-ready scene description produced by the glTF import or read back from the scene cache.
+// Bulk data (vertices, indices, texels) are spans, either into the owned storage or into the mapped cache file.
+
+struct CookedImage {
+    vk::Format format{ vk::Format::eR8G8B8A8Unorm };
+    vk::Extent2D extent{};
+    uint32_t mipLevels{ 1U }; // levels stored in texels, missing ones are generated on upload
+    std::span< const std::byte > texels;
+    std::shared_ptr< const void > storage{};
+};
+
+struct CookedSampler {
+    std::optional< fastgltf::Filter > magFilter;
+    std::optional< fastgltf::Filter > minFilter;
+};
+
+struct CookedTexture {
+    int32_t imageIndex{ -1 };
+    int32_t samplerIndex{ -1 };
+};
+
+struct CookedMaterial {
+    std::string name;
+    glm::vec4 colorFactors{ 1.0F };
+    glm::vec4 metalicRoughnessFactors{};
+    ve::Material::Type type{ ve::Material::Type::eMainColor };
+    float alphaCutoff{ 0.5F };
+    CookedTexture baseColor;
+    CookedTexture normal;
+    CookedTexture metalicRoughness;
+};
+
+struct CookedSurface {
+    uint32_t startIndex{};
+    uint32_t count{};
+    int32_t materialIndex{ -1 };
+    std::array< ve::SurfaceLod, ve::g_maxSurfaceLods > lods{}; // in the same index array as the surface
+    uint32_t lodsCount{};
+    ve::Bounds bounds{};
+};
+
+struct CookedMesh {
+    std::string name;
+    uint32_t firstSurface{};
+    uint32_t surfacesCount{};
+    uint32_t firstVertex{};
+    uint32_t verticesCount{};
+    glm::vec4 positionOffset{ 0.0F }; // dequantization of packed positions: offset + scale * position
+    glm::vec4 positionScale{ 1.0F };
+    glm::vec4 boundingSphere{ 0.0F }; // center and radius
+    vk::IndexType indexType{ vk::IndexType::eUint32 }; // selects the index array the surfaces point into
+};
+
+struct CookedNode {
+    std::string name;
+    glm::mat4 localTransform{ 1.0F };
+    int32_t meshIndex{ -1 };
+    int32_t parentIndex{ -1 };
+    uint32_t firstInstance{};            // EXT_mesh_gpu_instancing transforms in instanceTransforms
+    uint32_t instancesCount{};           // 0 when the node is not instanced
+    glm::vec4 instancesBoundingSphere{}; // of the mesh over all instances, in node space
+};
+
+struct CookedScene {
+    CookedScene()                                = default;
+    CookedScene( const CookedScene& )            = delete;
+    CookedScene( CookedScene&& )                 = default;
+    CookedScene& operator=( const CookedScene& ) = delete;
+    CookedScene& operator=( CookedScene&& )      = default;
+
+    std::vector< CookedSampler > samplers;
+    std::vector< CookedImage > images;
+    std::vector< CookedMaterial > materials;
+    std::vector< CookedSurface > surfaces;
+    std::vector< CookedMesh > meshes;
+    std::vector< CookedNode > nodes;
+    std::span< const ve::Vertex > vertices; // empty when the vertices are packed
+    std::span< const ve::PackedVertex > packedVertices;
+    std::span< const uint32_t > indices;
+    std::span< const uint16_t > shortIndices;
+    std::span< const glm::mat4 > instanceTransforms;
+
+    std::vector< ve::Vertex > vertexStorage;
+    std::vector< ve::PackedVertex > packedVertexStorage;
+    std::vector< uint32_t > indexStorage;
+    std::vector< uint16_t > shortIndexStorage;
+    std::vector< glm::mat4 > instanceTransformStorage;
+    std::shared_ptr< const ve::MappedFile > mapping{};
+};
+
+} // namespace ve::gltf
+
+namespace ve::gltf::cache {
+
+// options describe how the scene was cooked, a cache written with different options is outdated
+inline constexpr uint32_t g_blockCompressionOption{ 1U << 0U };
+inline constexpr uint32_t g_packedVerticesOption{ 1U << 1U };
+inline constexpr uint32_t g_optimizedIndicesOption{ 1U << 2U };
+inline constexpr uint32_t g_shortIndicesOption{ 1U << 3U };
+inline constexpr uint32_t g_lodsOption{ 1U << 4U };
+
+std::filesystem::path getCachePath( const std::filesystem::path& sourcePath );
+
+// Returns std::nullopt when the cache is missing, outdated or corrupted.
+std::optional< CookedScene > read( const std::filesystem::path& cachePath, const std::filesystem::path& sourcePath,
+                                   const uint32_t options );
+bool write( const std::filesystem::path& cachePath, const std::filesystem::path& sourcePath, const uint32_t options,
+            const CookedScene& scene );
+
+} // namespace ve::gltf::cache
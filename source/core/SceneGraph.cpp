@@ -0,0 +1,74 @@
+#include "SceneGraph.hpp"
+
+#include <glm/mat3x3.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+ve::Affine compose( const ve::Affine& parent, const ve::Affine& local ) noexcept {
+    const glm::mat3 basis{ parent };
+    return ve::Affine{ basis * local[ 0 ], basis * local[ 1 ], basis * local[ 2 ], basis * local[ 3 ] + parent[ 3 ] };
+}
+
+} // namespace
+
+namespace ve {
+
+void SceneGraph::reserve( const size_t count ) {
+    m_localTransforms.reserve( count );
+    m_worldTransforms.reserve( count );
+    m_parents.reserve( count );
+    m_dirtyFlags.reserve( count );
+}
+
+uint32_t SceneGraph::addNode( const uint32_t parent, const glm::mat4& localTransform ) {
+    const auto node{ static_cast< uint32_t >( size() ) };
+    if ( parent != g_noParent && parent >= node )
+        throw std::runtime_error( "scene graph parent has to be added before its children" );
+
+    const ve::Affine local{ localTransform };
+    m_localTransforms.emplace_back( local );
+    m_worldTransforms.emplace_back( parent == g_noParent ? local : compose( m_worldTransforms[ parent ], local ) );
+    m_parents.emplace_back( parent );
+    m_dirtyFlags.emplace_back( uint8_t{ 0U } );
+
+    return node;
+}
+
+void SceneGraph::setLocalTransform( const uint32_t node, const glm::mat4& transform ) noexcept {
+    m_localTransforms[ node ] = ve::Affine{ transform };
+    m_dirtyFlags[ node ]      = 1U;
+    m_firstDirty              = std::min( m_firstDirty, size_t{ node } );
+}
+
+size_t SceneGraph::updateWorldTransforms() {
+    m_updatedNodes.clear();
+    if ( !isDirty() )
+        return 0U;
+
+    // a parent always comes first, so its world transform is final by the time its children are reached, and its
+    // dirty flag is passed on to them within the same sweep
+    const size_t nodesCount{ size() };
+    for ( size_t node{ m_firstDirty }; node < nodesCount; node++ ) {
+        const uint32_t parent{ m_parents[ node ] };
+        const bool isParentDirty{ parent != g_noParent && m_dirtyFlags[ parent ] != 0U };
+        if ( m_dirtyFlags[ node ] == 0U && !isParentDirty )
+            continue;
+
+        m_dirtyFlags[ node ]      = 1U;
+        m_worldTransforms[ node ] = parent == g_noParent
+                                        ? m_localTransforms[ node ]
+                                        : compose( m_worldTransforms[ parent ], m_localTransforms[ node ] );
+        m_updatedNodes.emplace_back( static_cast< uint32_t >( node ) );
+    }
+
+    std::fill( std::begin( m_dirtyFlags ) + static_cast< ptrdiff_t >( m_firstDirty ), std::end( m_dirtyFlags ),
+               uint8_t{ 0U } );
+    m_firstDirty = std::numeric_limits< size_t >::max();
+
+    return std::size( m_updatedNodes );
+}
+
+} // namespace ve
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/mat4x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace ve {
+
+// affine transform without its constant ( 0, 0, 0, 1 ) row
+using Affine = glm::mat4x3;
+
+// Node hierarchy kept in flat arrays. Parents are stored before their children, so world transforms are computed
+// in a single linear sweep without recursion. Changed local transforms are tracked, an update only recomputes the
+// changed nodes and their descendants, and does no matrix work at all for a static scene.
+class SceneGraph {
+public:
+    static constexpr uint32_t g_noParent{ std::numeric_limits< uint32_t >::max() };
+
+    void reserve( const size_t count );
+    // the parent has to be added first, returns the index of the new node
+    uint32_t addNode( const uint32_t parent, const glm::mat4& localTransform );
+    void setLocalTransform( const uint32_t node, const glm::mat4& transform ) noexcept;
+    // returns the number of recomputed world transforms
+    size_t updateWorldTransforms();
+    bool isDirty() const noexcept { return m_firstDirty < size(); }
+    // nodes recomputed by the last update, in ascending order
+    std::span< const uint32_t > getUpdatedNodes() const noexcept { return m_updatedNodes; }
+
+    glm::mat4 getWorldTransform( const uint32_t node ) const noexcept { return glm::mat4{ m_worldTransforms[ node ] }; }
+    glm::mat4 getLocalTransform( const uint32_t node ) const noexcept { return glm::mat4{ m_localTransforms[ node ] }; }
+    uint32_t getParent( const uint32_t node ) const noexcept { return m_parents[ node ]; }
+    size_t size() const noexcept { return std::size( m_parents ); }
+
+private:
+    std::vector< ve::Affine > m_localTransforms;
+    std::vector< ve::Affine > m_worldTransforms;
+    std::vector< uint32_t > m_parents;
+    std::vector< uint8_t > m_dirtyFlags;
+    std::vector< uint32_t > m_updatedNodes;
+    size_t m_firstDirty{ std::numeric_limits< size_t >::max() }; // the sweep starts here, nothing before changed
+};
+
+} // namespace ve
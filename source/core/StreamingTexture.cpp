@@ -0,0 +1,69 @@
+#include "StreamingTexture.hpp"
+#include "Config.hpp"
+#include "TextureProcessing.hpp"
+#include "UploadBatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ve {
+
+StreamingTexture::StreamingTexture( const ve::gltf::CookedImage& source ) : m_source{ source } {
+    if ( m_source.mipLevels == 1U && !ve::texture::isBlockCompressed( m_source.format ) )
+        m_levelsCount = ve::texture::getMipLevelsCount( m_source.extent );
+    else
+        m_levelsCount = m_source.mipLevels;
+}
+
+std::optional< ve::Image > StreamingTexture::makeResident( ve::UploadBatch& uploadBatch, const uint32_t firstLevel ) {
+    static constexpr vk::ImageUsageFlags usage{ vk::ImageUsageFlagBits::eTransferSrc |
+                                                vk::ImageUsageFlagBits::eTransferDst |
+                                                vk::ImageUsageFlagBits::eSampled };
+
+    const uint32_t level{ isStreamable() ? std::min( firstLevel, m_levelsCount - 1U ) : 0U };
+    const uint32_t mipLevels{ m_levelsCount - level };
+    const uint32_t providedLevels{ isStreamable() ? mipLevels : m_source.mipLevels };
+    const auto texels{ m_source.texels.subspan(
+        ve::texture::getMipChainSize( m_source.format, m_source.extent, level ) ) };
+
+    ve::Image image{ uploadBatch.createImage( texels, ve::texture::getMipExtent( m_source.extent, level ),
+                                              m_source.format, usage, mipLevels, providedLevels ) };
+
+    std::optional< ve::Image > previousImage{};
+    if ( m_image.has_value() )
+        previousImage.emplace( std::move( m_image.value() ) );
+
+    m_image.emplace( std::move( image ) );
+    m_firstLevel = level;
+    return previousImage;
+}
+
+uint32_t StreamingTexture::getDesiredLevel( const float screenSize ) const noexcept {
+    if ( !isStreamable() )
+        return 0U;
+
+    const float size{ static_cast< float >( std::max( m_source.extent.width, m_source.extent.height ) ) };
+    const float level{ std::floor( std::log2( size / std::max( screenSize, 1.0F ) ) ) };
+    return std::min( static_cast< uint32_t >( std::max( level, 0.0F ) ), getTailLevel() );
+}
+
+uint32_t StreamingTexture::getTailLevel() const noexcept {
+    if ( !isStreamable() )
+        return 0U;
+
+    uint32_t level{};
+    for ( ; level + 1U < m_levelsCount; level++ ) {
+        const auto extent{ ve::texture::getMipExtent( m_source.extent, level ) };
+        if ( std::max( extent.width, extent.height ) <= cfg::texture::streamingTailSize )
+            break;
+    }
+
+    return level;
+}
+
+vk::DeviceSize StreamingTexture::getResidentSize( const uint32_t firstLevel ) const noexcept {
+    return ve::texture::getMipChainSize( m_source.format, ve::texture::getMipExtent( m_source.extent, firstLevel ),
+                                         m_levelsCount - firstLevel );
+}
+
+} // namespace ve
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Image.hpp"
+#include "SceneCache.hpp"
+
+#include <optional>
+
+namespace ve {
+
+class UploadBatch;
+
+// Texture whose finest mip levels are made resident on demand. The CPU mip chain of the cooked image is kept, and
+// the GPU image holds the levels from getFirstLevel() down to the smallest one. Changing that range recreates the
+// image, so descriptors referencing the previous one have to be rewritten.
+class StreamingTexture {
+public:
+    // the texels of source have to outlive the texture
+    StreamingTexture( const ve::gltf::CookedImage& source );
+
+    // Uploads the levels from firstLevel on, returning the image it replaces. That one must be kept alive until no
+    // frame in flight samples it.
+    std::optional< ve::Image > makeResident( ve::UploadBatch& uploadBatch, const uint32_t firstLevel );
+
+    // the finest level still sharp when the texture covers screenSize pixels, never finer than needed
+    uint32_t getDesiredLevel( const float screenSize ) const noexcept;
+    uint32_t getTailLevel() const noexcept;
+    vk::DeviceSize getResidentSize( const uint32_t firstLevel ) const noexcept;
+    vk::DeviceSize getResidentSize() const noexcept { return getResidentSize( m_firstLevel ); }
+    // only complete CPU mip chains can be streamed, a single level gets its chain blitted on upload
+    bool isStreamable() const noexcept { return m_levelsCount > 1U && m_source.mipLevels == m_levelsCount; }
+
+    uint32_t getFirstLevel() const noexcept { return m_firstLevel; }
+    uint32_t getLevelsCount() const noexcept { return m_levelsCount; }
+    const ve::Image& getImage() const { return m_image.value(); }
+
+private:
+    ve::gltf::CookedImage m_source;
+    std::optional< ve::Image > m_image;
+    uint32_t m_levelsCount{};
+    uint32_t m_firstLevel{};
+};
+
+} // namespace ve
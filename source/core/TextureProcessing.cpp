@@ -0,0 +1,246 @@
+#include "TextureProcessing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+namespace {
+
+constexpr uint32_t g_blockDimension{ 4U };
+constexpr uint32_t g_blockTexelsCount{ g_blockDimension * g_blockDimension };
+
+float srgbToLinear( const float value ) noexcept {
+    return value <= 0.04045F ? value / 12.92F : std::pow( ( value + 0.055F ) / 1.055F, 2.4F );
+}
+
+uint8_t linearToSrgb( const float value ) noexcept {
+    const float srgb{ value <= 0.0031308F ? value * 12.92F : 1.055F * std::pow( value, 1.0F / 2.4F ) - 0.055F };
+    return static_cast< uint8_t >( std::clamp( srgb * 255.0F + 0.5F, 0.0F, 255.0F ) );
+}
+
+const std::array< float, 256U >& getSrgbToLinearTable() noexcept {
+    static const std::array< float, 256U > table{ [] {
+        std::array< float, 256U > values{};
+        for ( size_t index{ 0U }; index < std::size( values ); index++ )
+            values.at( index ) = srgbToLinear( static_cast< float >( index ) / 255.0F );
+        return values;
+    }() };
+
+    return table;
+}
+
+void downsample( const uint8_t *source, const vk::Extent2D sourceExtent, uint8_t *destination,
+                 const vk::Extent2D destinationExtent, const bool isSrgb ) {
+    const auto& toLinear{ getSrgbToLinearTable() };
+    constexpr uint32_t channels{ 4U };
+    constexpr uint32_t alphaChannel{ 3U };
+
+    for ( uint32_t y{ 0U }; y < destinationExtent.height; y++ ) {
+        const uint32_t y0{ std::min( y * 2U, sourceExtent.height - 1U ) };
+        const uint32_t y1{ std::min( y * 2U + 1U, sourceExtent.height - 1U ) };
+
+        for ( uint32_t x{ 0U }; x < destinationExtent.width; x++ ) {
+            const uint32_t x0{ std::min( x * 2U, sourceExtent.width - 1U ) };
+            const uint32_t x1{ std::min( x * 2U + 1U, sourceExtent.width - 1U ) };
+
+            const std::array< const uint8_t *, 4U > texels{ source + ( y0 * sourceExtent.width + x0 ) * channels,
+                                                            source + ( y0 * sourceExtent.width + x1 ) * channels,
+                                                            source + ( y1 * sourceExtent.width + x0 ) * channels,
+                                                            source + ( y1 * sourceExtent.width + x1 ) * channels };
+            uint8_t *output{ destination + ( y * destinationExtent.width + x ) * channels };
+
+            for ( uint32_t channel{ 0U }; channel < channels; channel++ ) {
+                if ( isSrgb && channel != alphaChannel ) {
+                    float sum{};
+                    for ( const auto *texel : texels )
+                        sum += toLinear.at( texel[ channel ] );
+                    output[ channel ] = linearToSrgb( sum * 0.25F );
+                } else {
+                    uint32_t sum{ 2U };
+                    for ( const auto *texel : texels )
+                        sum += texel[ channel ];
+                    output[ channel ] = static_cast< uint8_t >( sum / 4U );
+                }
+            }
+        }
+    }
+}
+
+// Gathers a 4x4 block of RGBA texels, clamping at the level edges for levels smaller than a block.
+std::array< uint8_t, g_blockTexelsCount * 4U > getBlock( const uint8_t *level, const vk::Extent2D extent,
+                                                        const uint32_t blockX, const uint32_t blockY ) noexcept {
+    std::array< uint8_t, g_blockTexelsCount * 4U > block{};
+    for ( uint32_t y{ 0U }; y < g_blockDimension; y++ ) {
+        const uint32_t sourceY{ std::min( blockY * g_blockDimension + y, extent.height - 1U ) };
+        for ( uint32_t x{ 0U }; x < g_blockDimension; x++ ) {
+            const uint32_t sourceX{ std::min( blockX * g_blockDimension + x, extent.width - 1U ) };
+            memcpy( std::data( block ) + ( y * g_blockDimension + x ) * 4U,
+                    level + ( static_cast< size_t >( sourceY ) * extent.width + sourceX ) * 4U, 4U );
+        }
+    }
+
+    return block;
+}
+
+void compressBlock( const std::array< uint8_t, g_blockTexelsCount * 4U >& block, const vk::Format blockFormat,
+                    uint8_t *destination ) {
+    switch ( blockFormat ) {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+        stb_compress_dxt_block( destination, std::data( block ), 0, STB_DXT_HIGHQUAL );
+        break;
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+        stb_compress_dxt_block( destination, std::data( block ), 1, STB_DXT_HIGHQUAL );
+        break;
+    case vk::Format::eBc5UnormBlock: {
+        std::array< uint8_t, g_blockTexelsCount * 2U > redGreen{};
+        for ( uint32_t texel{ 0U }; texel < g_blockTexelsCount; texel++ ) {
+            redGreen.at( texel * 2U )      = block.at( texel * 4U );
+            redGreen.at( texel * 2U + 1U ) = block.at( texel * 4U + 1U );
+        }
+        stb_compress_bc5_block( destination, std::data( redGreen ) );
+        break;
+    }
+    default:
+        throw std::runtime_error( "unsupported block compression format" );
+    }
+}
+
+vk::DeviceSize getBlockSize( const vk::Format format ) noexcept {
+    switch ( format ) {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc4UnormBlock:
+    case vk::Format::eBc4SnormBlock:
+        return 8U;
+    case vk::Format::eBc2UnormBlock:
+    case vk::Format::eBc2SrgbBlock:
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eBc5SnormBlock:
+    case vk::Format::eBc6HUfloatBlock:
+    case vk::Format::eBc6HSfloatBlock:
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+        return 16U;
+    default:
+        return 0U;
+    }
+}
+
+} // namespace
+
+namespace ve::texture {
+
+uint32_t getMipLevelsCount( const vk::Extent2D extent ) noexcept {
+    return static_cast< uint32_t >( std::floor( std::log2( std::max( extent.width, extent.height ) ) ) ) + 1U;
+}
+
+vk::Extent2D getMipExtent( const vk::Extent2D extent, const uint32_t mipLevel ) noexcept {
+    return { std::max( extent.width >> mipLevel, 1U ), std::max( extent.height >> mipLevel, 1U ) };
+}
+
+vk::DeviceSize getLevelSize( const vk::Format format, const vk::Extent2D extent ) noexcept {
+    if ( !isBlockCompressed( format ) )
+        return static_cast< vk::DeviceSize >( extent.width ) * extent.height * g_rgbaTexelSize;
+
+    const vk::DeviceSize blockSize{ getBlockSize( format ) };
+    const vk::DeviceSize blocksX{ ( extent.width + g_blockDimension - 1U ) / g_blockDimension };
+    const vk::DeviceSize blocksY{ ( extent.height + g_blockDimension - 1U ) / g_blockDimension };
+
+    return blocksX * blocksY * blockSize;
+}
+
+vk::DeviceSize getMipChainSize( const vk::Format format, const vk::Extent2D extent,
+                                const uint32_t mipLevels ) noexcept {
+    vk::DeviceSize size{};
+    for ( uint32_t mipLevel{ 0U }; mipLevel < mipLevels; mipLevel++ )
+        size += getLevelSize( format, getMipExtent( extent, mipLevel ) );
+
+    return size;
+}
+
+bool isBlockCompressed( const vk::Format format ) noexcept {
+    return getBlockSize( format ) != 0U;
+}
+
+vk::Format getUncompressedFormat( const Usage usage ) noexcept {
+    return usage == Usage::eColor ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+}
+
+vk::Format getBlockFormat( const Usage usage, const bool hasAlpha ) noexcept {
+    switch ( usage ) {
+    case Usage::eColor:
+        return hasAlpha ? vk::Format::eBc3SrgbBlock : vk::Format::eBc1RgbSrgbBlock;
+    case Usage::eNormal:
+        return vk::Format::eBc5UnormBlock;
+    case Usage::eData:
+    default:
+        return hasAlpha ? vk::Format::eBc3UnormBlock : vk::Format::eBc1RgbUnormBlock;
+    }
+}
+
+bool hasTranslucentTexels( std::span< const std::byte > texels ) noexcept {
+    for ( size_t alphaIndex{ 3U }; alphaIndex < std::size( texels ); alphaIndex += g_rgbaTexelSize )
+        if ( texels[ alphaIndex ] != std::byte{ 0xFF } )
+            return true;
+
+    return false;
+}
+
+std::vector< std::byte > generateMipChain( std::span< const std::byte > baseLevel, const vk::Extent2D extent,
+                                           const bool isSrgb ) {
+    const uint32_t mipLevels{ getMipLevelsCount( extent ) };
+    std::vector< std::byte > mipChain( getMipChainSize( vk::Format::eR8G8B8A8Unorm, extent, mipLevels ) );
+    memcpy( std::data( mipChain ), std::data( baseLevel ), std::min( std::size( baseLevel ), std::size( mipChain ) ) );
+
+    vk::DeviceSize sourceOffset{};
+    for ( uint32_t mipLevel{ 1U }; mipLevel < mipLevels; mipLevel++ ) {
+        const auto sourceExtent{ getMipExtent( extent, mipLevel - 1U ) };
+        const auto destinationExtent{ getMipExtent( extent, mipLevel ) };
+        const vk::DeviceSize destinationOffset{ sourceOffset + static_cast< vk::DeviceSize >( sourceExtent.width ) *
+                                                                   sourceExtent.height * g_rgbaTexelSize };
+
+        auto *data{ reinterpret_cast< uint8_t * >( std::data( mipChain ) ) };
+        downsample( data + sourceOffset, sourceExtent, data + destinationOffset, destinationExtent, isSrgb );
+        sourceOffset = destinationOffset;
+    }
+
+    return mipChain;
+}
+
+std::vector< std::byte > compressMipChain( std::span< const std::byte > mipChain, const vk::Extent2D extent,
+                                           const uint32_t mipLevels, const vk::Format blockFormat ) {
+    std::vector< std::byte > blocks( getMipChainSize( blockFormat, extent, mipLevels ) );
+    const vk::DeviceSize blockSize{ getLevelSize( blockFormat, { g_blockDimension, g_blockDimension } ) };
+
+    const auto *source{ reinterpret_cast< const uint8_t * >( std::data( mipChain ) ) };
+    auto *destination{ reinterpret_cast< uint8_t * >( std::data( blocks ) ) };
+    for ( uint32_t mipLevel{ 0U }; mipLevel < mipLevels; mipLevel++ ) {
+        const auto mipExtent{ getMipExtent( extent, mipLevel ) };
+        const uint32_t blocksX{ ( mipExtent.width + g_blockDimension - 1U ) / g_blockDimension };
+        const uint32_t blocksY{ ( mipExtent.height + g_blockDimension - 1U ) / g_blockDimension };
+
+        for ( uint32_t blockY{ 0U }; blockY < blocksY; blockY++ ) {
+            for ( uint32_t blockX{ 0U }; blockX < blocksX; blockX++ ) {
+                compressBlock( getBlock( source, mipExtent, blockX, blockY ), blockFormat, destination );
+                destination += blockSize;
+            }
+        }
+
+        source += getLevelSize( vk::Format::eR8G8B8A8Unorm, mipExtent );
+    }
+
+    return blocks;
+}
+
+} // namespace ve::texture
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace ve::texture {
+
+inline constexpr vk::DeviceSize g_rgbaTexelSize{ 4U };
+
+enum class Usage { eColor, eNormal, eData };
+
+uint32_t getMipLevelsCount( const vk::Extent2D extent ) noexcept;
+vk::Extent2D getMipExtent( const vk::Extent2D extent, const uint32_t mipLevel ) noexcept;
+vk::DeviceSize getLevelSize( const vk::Format format, const vk::Extent2D extent ) noexcept;
+vk::DeviceSize getMipChainSize( const vk::Format format, const vk::Extent2D extent,
+                                const uint32_t mipLevels ) noexcept;
+
+bool isBlockCompressed( const vk::Format format ) noexcept;
+vk::Format getUncompressedFormat( const Usage usage ) noexcept;
+vk::Format getBlockFormat( const Usage usage, const bool hasAlpha ) noexcept;
+bool hasTranslucentTexels( std::span< const std::byte > texels ) noexcept;
+
+// Box-filters an RGBA8 image down to 1x1. Levels are tightly packed, starting with a copy of the base level.
+// sRGB data is averaged in linear space, which matches what a linear blit does for sRGB formats.
+std::vector< std::byte > generateMipChain( std::span< const std::byte > baseLevel, const vk::Extent2D extent,
+                                           const bool isSrgb );
+
+// Encodes a packed RGBA8 mip chain into BC1, BC3 or BC5 blocks, level by level.
+std::vector< std::byte > compressMipChain( std::span< const std::byte > mipChain, const vk::Extent2D extent,
+                                           const uint32_t mipLevels, const vk::Format blockFormat );
+
+} // namespace ve::texture
@@ -0,0 +1,172 @@
+#include "UploadBatch.hpp"
+#include "Constants.hpp"
+#include "Config.hpp"
+#include "TextureProcessing.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+constexpr vk::DeviceSize g_stagingAlignment{ 16U };
+
+constexpr vk::DeviceSize alignUp( const vk::DeviceSize value, const vk::DeviceSize alignment ) noexcept {
+    return ( value + alignment - 1U ) & ~( alignment - 1U );
+}
+} // namespace
+
+namespace ve {
+
+UploadBatch::UploadBatch( const ve::MemoryAllocator& memoryAllocator, const ve::LogicalDevice& logicalDevice,
+                          const ve::GraphicsCommandBuffer commandBuffer, const ve::Fence& fence )
+    : m_memoryAllocator{ memoryAllocator },
+      m_logicalDevice{ logicalDevice },
+      m_commandBuffer{ commandBuffer },
+      m_fence{ fence } {}
+
+UploadBatch::~UploadBatch() {
+    // nothing is submitted from here, the batch is also destroyed while unwinding from a failed upload and its
+    // recording is then incomplete
+    if ( m_isRecording )
+        spdlog::warn( "Upload batch destroyed without submitting, {} images were not uploaded", m_imagesCount );
+
+    // the staging memory of a submission still executing has to outlive it
+    if ( m_isSubmitted ) {
+        try {
+            wait();
+        } catch ( const std::exception& exception ) {
+            spdlog::error( "Failed to wait for the last upload: {}", exception.what() );
+        }
+    }
+}
+
+ve::Image UploadBatch::createImage( std::span< const std::byte > texels, const vk::Extent2D extent,
+                                    const vk::Format format, const vk::ImageUsageFlags usage, const uint32_t mipLevels,
+                                    const uint32_t providedLevels ) {
+    const uint32_t copiedLevels{ providedLevels >= mipLevels ? mipLevels : 1U };
+    if ( copiedLevels != mipLevels && ve::texture::isBlockCompressed( format ) )
+        throw std::runtime_error( "block compressed images require a full mip chain" );
+
+    const vk::DeviceSize size{ ve::texture::getMipChainSize( format, extent, copiedLevels ) };
+    if ( std::size( texels ) < size )
+        throw std::runtime_error( "image data is smaller than its mip chain" );
+
+    const auto [ stagingBuffer, stagingOffset ]{ stage( std::data( texels ), size ) };
+
+    ve::Image image{ m_memoryAllocator, m_logicalDevice, extent, format, usage, vk::ImageAspectFlagBits::eColor,
+                     mipLevels };
+
+    beginRecording();
+    m_commandBuffer.transitionImageLayout( image.get(), format, vk::ImageLayout::eUndefined,
+                                           vk::ImageLayout::eTransferDstOptimal, mipLevels );
+
+    vk::DeviceSize levelOffset{ stagingOffset };
+    for ( uint32_t mipLevel{ 0U }; mipLevel < copiedLevels; mipLevel++ ) {
+        const auto mipExtent{ ve::texture::getMipExtent( extent, mipLevel ) };
+        m_commandBuffer.copyBufferToImage( stagingBuffer, image.get(), mipExtent, 1U, levelOffset, mipLevel );
+        levelOffset += ve::texture::getLevelSize( format, mipExtent );
+    }
+
+    if ( copiedLevels == mipLevels ) {
+        m_commandBuffer.transitionImageLayout( image.get(), format, vk::ImageLayout::eTransferDstOptimal,
+                                               vk::ImageLayout::eShaderReadOnlyOptimal, mipLevels );
+    } else if ( supportsLinearBlit( format ) ) {
+        m_commandBuffer.generateMipmaps( image.get(), extent, mipLevels );
+    } else {
+        spdlog::warn( "Image format does not support linear blitting. Mipmapping ommited." );
+        m_commandBuffer.transitionImageLayout( image.get(), format, vk::ImageLayout::eTransferDstOptimal,
+                                               vk::ImageLayout::eShaderReadOnlyOptimal, mipLevels );
+    }
+
+    m_imagesCount++;
+    return image;
+}
+
+void UploadBatch::submit() {
+    if ( !m_isRecording )
+        return;
+
+    m_commandBuffer.end();
+
+    const auto logicalDeviceVk{ m_logicalDevice.get() };
+    const auto commandBufferVk{ m_commandBuffer.get() };
+    logicalDeviceVk.resetFences( m_fence.get() );
+
+    vk::SubmitInfo submitInfo{};
+    submitInfo.sType              = vk::StructureType::eSubmitInfo;
+    submitInfo.commandBufferCount = 1U;
+    submitInfo.pCommandBuffers    = &commandBufferVk;
+
+    m_logicalDevice.getQueue( ve::QueueType::eGraphics ).submit( submitInfo, m_fence.get() );
+
+    // the images are read by frames submitted later to the same queue, which the final barriers already order
+    m_submittedChunks = std::move( m_stagingChunks );
+    m_stagingChunks.clear();
+    m_chunkOffset  = 0U;
+    m_pendingBytes = 0U;
+    m_isRecording  = false;
+    m_isSubmitted  = true;
+    m_submitsCount++;
+}
+
+bool UploadBatch::poll() {
+    if ( !m_isSubmitted )
+        return true;
+
+    if ( m_logicalDevice.get().getFenceStatus( m_fence.get() ) != vk::Result::eSuccess )
+        return false;
+
+    m_submittedChunks.clear();
+    m_isSubmitted = false;
+    return true;
+}
+
+void UploadBatch::wait() {
+    if ( !m_isSubmitted )
+        return;
+
+    [[maybe_unused]] const auto waitForFencesResult{
+        m_logicalDevice.get().waitForFences( m_fence.get(), g_waitForAllFences, g_timeoutOff ) };
+
+    m_submittedChunks.clear();
+    m_isSubmitted = false;
+}
+
+UploadBatch::StagingRegion UploadBatch::stage( const void *data, const vk::DeviceSize size ) {
+    if ( m_pendingBytes + size > cfg::upload::stagingBudget )
+        submit();
+
+    vk::DeviceSize offset{ alignUp( m_chunkOffset, g_stagingAlignment ) };
+    if ( m_stagingChunks.empty() || offset + size > m_stagingChunks.back().size() ) {
+        m_stagingChunks.emplace_back( m_memoryAllocator, std::max( size, cfg::upload::stagingChunkSize ) );
+        offset = 0U;
+    }
+
+    const auto& chunk{ m_stagingChunks.back() };
+    memcpy( static_cast< std::byte * >( chunk.getMappedMemory() ) + offset, data, size );
+
+    m_chunkOffset = offset + size;
+    m_pendingBytes += size;
+
+    return { chunk.get(), offset };
+}
+
+void UploadBatch::beginRecording() {
+    if ( m_isRecording )
+        return;
+
+    // the command buffer is still pending while the previous submission executes
+    wait();
+    m_commandBuffer.reset();
+    m_commandBuffer.begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+    m_isRecording = true;
+}
+
+bool UploadBatch::supportsLinearBlit( const vk::Format format ) const {
+    const auto formatProperties{ m_logicalDevice.getParentPhysicalDevice().get().getFormatProperties( format ) };
+    return static_cast< bool >( formatProperties.optimalTilingFeatures &
+                                vk::FormatFeatureFlagBits::eSampledImageFilterLinear );
+}
+
+} // namespace ve
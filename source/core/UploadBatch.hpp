@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Buffer.hpp"
+#include "Image.hpp"
+#include "SyncObjects.hpp"
+
+#include "command/GraphicsCommandBuffer.hpp"
+
+#include "utils/NonCopyable.hpp"
+#include "utils/NonMovable.hpp"
+
+#include <span>
+#include <vector>
+
+namespace ve {
+
+// Records many image uploads into one command buffer, backed by a shared staging arena.
+// submit() does not wait: the staging memory is kept until poll() sees the fence signaled, and recording waits for
+// the previous submission only when it starts before that one finished, e.g. when the staging budget is exceeded.
+// Recorded work which is not submitted explicitly is discarded on destruction.
+class UploadBatch : public utils::NonCopyable,
+                    public utils::NonMovable {
+public:
+    UploadBatch( const ve::MemoryAllocator& memoryAllocator, const ve::LogicalDevice& logicalDevice,
+                 const ve::GraphicsCommandBuffer commandBuffer, const ve::Fence& fence );
+    ~UploadBatch();
+
+    // texels hold providedLevels tightly packed mip levels, the rest of the chain is blitted on the GPU
+    ve::Image createImage( std::span< const std::byte > texels, const vk::Extent2D extent, const vk::Format format,
+                           const vk::ImageUsageFlags usage, const uint32_t mipLevels = 1U,
+                           const uint32_t providedLevels = 1U );
+    void submit();
+    // releases the staging memory of a finished submission, returns whether nothing is executing anymore
+    bool poll();
+
+    uint32_t getSubmitsCount() const noexcept { return m_submitsCount; }
+    uint32_t getImagesCount() const noexcept { return m_imagesCount; }
+
+private:
+    struct StagingRegion {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+    };
+
+    const ve::MemoryAllocator& m_memoryAllocator;
+    const ve::LogicalDevice& m_logicalDevice;
+    ve::GraphicsCommandBuffer m_commandBuffer;
+    const ve::Fence& m_fence;
+    std::vector< ve::StagingBuffer > m_stagingChunks;
+    std::vector< ve::StagingBuffer > m_submittedChunks;
+    vk::DeviceSize m_chunkOffset{};
+    vk::DeviceSize m_pendingBytes{};
+    uint32_t m_submitsCount{};
+    uint32_t m_imagesCount{};
+    bool m_isRecording{ false };
+    bool m_isSubmitted{ false };
+
+    StagingRegion stage( const void *data, const vk::DeviceSize size );
+    void beginRecording();
+    void wait();
+    bool supportsLinearBlit( const vk::Format format ) const;
+};
+
+} // namespace ve
@@ -3,6 +3,8 @@
 #include <glm/vec4.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstdint>
+
 namespace ve {
 
 struct Vertex {
@@ -14,4 +16,17 @@ struct Vertex {
     glm::vec4 tangent{ 0.0F };
 };
 
+// Compact layout decoded in Mesh.vert. Positions are unorm16 inside the mesh bounds (dequantized with the
+// per-mesh offset and scale), normal and tangent are octahedral snorm16, uv is half float. The tangent sign is
+// stored in the upper half of positionZ. Color is not read by any shader, so it is not stored.
+struct PackedVertex {
+    uint32_t positionXY{};
+    uint32_t positionZ{};
+    uint32_t normal{};
+    uint32_t tangent{};
+    uint32_t uv{};
+};
+
+static_assert( sizeof( PackedVertex ) == 20U );
+
 } // namespace ve
@@ -1,8 +1,11 @@
 #include "GraphicsCommandBuffer.hpp"
+#include "Config.hpp"
 #include "QueueFamilyIDs.hpp"
 #include "LogicalDevice.hpp"
 #include "Mesh.hpp"
 
+#include <cstring>
+
 namespace {
 constexpr uint32_t g_firstVertex{ 0U };
 constexpr uint32_t g_instanceCount{ 1U };
@@ -23,7 +26,21 @@ uint32_t GraphicsCommandBuffer::getQueueFamilyID( const ve::LogicalDevice& logic
     return logicalDevice.getQueueFamilyIDs().at( ve::FamilyType::eGraphics );
 }
 
+void GraphicsCommandBuffer::begin( const vk::CommandBufferUsageFlags flags ) const {
+    BaseCommandBuffer::begin( flags );
+    *m_state = BoundState{};
+}
+
+void GraphicsCommandBuffer::reset() const {
+    BaseCommandBuffer::reset();
+    *m_state = BoundState{};
+}
+
 void GraphicsCommandBuffer::bindPipeline( const vk::Pipeline pipeline ) const noexcept {
+    if ( isRedundant( m_state->pipeline == pipeline ) )
+        return;
+
+    m_state->pipeline = pipeline;
     m_commandBuffer.bindPipeline( vk::PipelineBindPoint::eGraphics, pipeline );
 }
 
@@ -39,13 +56,30 @@ void GraphicsCommandBuffer::bindVertexBuffer( const vk::Buffer vertexBuffer ) co
     m_commandBuffer.bindVertexBuffers( g_firstBinding, vertexBuffer, g_offset );
 }
 
-void GraphicsCommandBuffer::bindIndexBuffer( const vk::Buffer indexBuffer ) const {
-    m_commandBuffer.bindIndexBuffer( indexBuffer, g_offset, vk::IndexType::eUint32 );
+void GraphicsCommandBuffer::bindIndexBuffer( const vk::Buffer indexBuffer, const vk::IndexType indexType,
+                                             const vk::DeviceSize offset ) const {
+    auto& state{ *m_state };
+    if ( isRedundant( state.indexBuffer == indexBuffer && state.indexType == indexType &&
+                      state.indexBufferOffset == offset ) )
+        return;
+
+    state.indexBuffer       = indexBuffer;
+    state.indexType         = indexType;
+    state.indexBufferOffset = offset;
+    m_commandBuffer.bindIndexBuffer( indexBuffer, offset, indexType );
 }
 
 void GraphicsCommandBuffer::bindDescriptorSet( const vk::PipelineLayout pipelineLayout,
                                                const vk::DescriptorSet descriptorSet,
                                                const uint32_t firstSet ) const noexcept {
+    useLayout( pipelineLayout );
+    auto& descriptorSets{ m_state->descriptorSets };
+    const bool isTracked{ firstSet < std::size( descriptorSets ) };
+    if ( isRedundant( isTracked && descriptorSets[ firstSet ] == descriptorSet ) )
+        return;
+
+    if ( isTracked )
+        descriptorSets[ firstSet ] = descriptorSet;
     m_commandBuffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, pipelineLayout, firstSet, descriptorSet,
                                         nullptr );
 }
@@ -54,8 +88,9 @@ void GraphicsCommandBuffer::drawVertices( const uint32_t firstVertex, const uint
     m_commandBuffer.draw( vertexCount, g_instanceCount, g_firstIndex, g_firstInstance );
 }
 
-void GraphicsCommandBuffer::drawIndices( const uint32_t firstIndex, const uint32_t indicesCount ) const noexcept {
-    m_commandBuffer.drawIndexed( indicesCount, g_instanceCount, firstIndex, g_offset, g_firstInstance );
+void GraphicsCommandBuffer::drawIndices( const uint32_t firstIndex, const uint32_t indicesCount,
+                                         const uint32_t instanceCount ) const noexcept {
+    m_commandBuffer.drawIndexed( indicesCount, instanceCount, firstIndex, g_offset, g_firstInstance );
 }
 
 void GraphicsCommandBuffer::transitionImageLayout( const vk::Image image, [[maybe_unused]] const vk::Format format,
@@ -112,14 +147,15 @@ void GraphicsCommandBuffer::transitionImageLayout( const vk::Image image, [[mayb
 }
 
 void GraphicsCommandBuffer::copyBufferToImage( const vk::Buffer buffer, const vk::Image image,
-                                               const vk::Extent2D extent, const uint32_t layerCount ) {
+                                               const vk::Extent2D extent, const uint32_t layerCount,
+                                               const vk::DeviceSize bufferOffset, const uint32_t mipLevel ) {
     vk::BufferImageCopy copyRegion{};
-    copyRegion.bufferOffset      = 0U;
+    copyRegion.bufferOffset      = bufferOffset;
     copyRegion.bufferRowLength   = 0U;
     copyRegion.bufferImageHeight = 0U;
 
     copyRegion.imageSubresource.aspectMask     = vk::ImageAspectFlagBits::eColor;
-    copyRegion.imageSubresource.mipLevel       = 0U;
+    copyRegion.imageSubresource.mipLevel       = mipLevel;
     copyRegion.imageSubresource.baseArrayLayer = 0U;
     copyRegion.imageSubresource.layerCount     = layerCount;
 
@@ -129,10 +165,96 @@ void GraphicsCommandBuffer::copyBufferToImage( const vk::Buffer buffer, const vk
     m_commandBuffer.copyBufferToImage( buffer, image, vk::ImageLayout::eTransferDstOptimal, copyRegion );
 }
 
+void GraphicsCommandBuffer::generateMipmaps( const vk::Image image, const vk::Extent2D extent,
+                                             const uint32_t mipLevels ) const {
+    vk::ImageMemoryBarrier barrier{};
+    barrier.image                           = image;
+    barrier.srcQueueFamilyIndex             = vk::QueueFamilyIgnored;
+    barrier.dstQueueFamilyIndex             = vk::QueueFamilyIgnored;
+    barrier.subresourceRange.aspectMask     = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.baseArrayLayer = 0U;
+    barrier.subresourceRange.layerCount     = 1U;
+    barrier.subresourceRange.levelCount     = 1U;
+
+    int32_t mipWidth{ static_cast< int32_t >( extent.width ) };
+    int32_t mipHeight{ static_cast< int32_t >( extent.height ) };
+    vk::Offset3D destinationMipmapSize{};
+    static constexpr int offsetStartID{ 0 };
+    static constexpr int offsetEndID{ 1 };
+
+    for ( uint32_t mipLevel{ 1 }; mipLevel < mipLevels; ++mipLevel ) {
+        barrier.subresourceRange.baseMipLevel = mipLevel - 1U;
+        barrier.oldLayout                     = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout                     = vk::ImageLayout::eTransferSrcOptimal;
+        barrier.srcAccessMask                 = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask                 = vk::AccessFlagBits::eTransferRead;
+
+        m_commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                                         vk::DependencyFlags{}, nullptr, nullptr, barrier );
+
+        vk::ImageBlit blit{};
+        blit.srcOffsets.at( offsetStartID ) = vk::Offset3D{ 0, 0, 0 };
+        blit.srcOffsets.at( offsetEndID )   = vk::Offset3D{ mipWidth, mipHeight, 1 };
+        blit.srcSubresource.aspectMask      = vk::ImageAspectFlagBits::eColor;
+        blit.srcSubresource.mipLevel        = mipLevel - 1U;
+        blit.srcSubresource.baseArrayLayer  = 0U;
+        blit.srcSubresource.layerCount      = 1U;
+
+        destinationMipmapSize = vk::Offset3D{ mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
+
+        blit.dstOffsets.at( offsetStartID ) = vk::Offset3D{ 0, 0, 0 };
+        blit.dstOffsets.at( offsetEndID )   = destinationMipmapSize;
+        blit.dstSubresource.aspectMask      = vk::ImageAspectFlagBits::eColor;
+        blit.dstSubresource.mipLevel        = mipLevel;
+        blit.dstSubresource.baseArrayLayer  = 0U;
+        blit.dstSubresource.layerCount      = 1U;
+
+        m_commandBuffer.blitImage( image, vk::ImageLayout::eTransferSrcOptimal, image,
+                                   vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear );
+
+        barrier.oldLayout     = vk::ImageLayout::eTransferSrcOptimal;
+        barrier.newLayout     = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+        m_commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer,
+                                         vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags{}, nullptr,
+                                         nullptr, barrier );
+
+        if ( mipWidth > 1 )
+            mipWidth /= 2;
+        if ( mipHeight > 1 )
+            mipHeight /= 2;
+    }
+
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout                     = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout                     = vk::ImageLayout::eShaderReadOnlyOptimal;
+    barrier.srcAccessMask                 = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask                 = vk::AccessFlagBits::eShaderRead;
+
+    m_commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+                                     vk::DependencyFlags{}, nullptr, nullptr, barrier );
+}
+
 void GraphicsCommandBuffer::pushConstants( const vk::PipelineLayout layout, const vk::ShaderStageFlags shaderStages,
                                            const ve::PushConstants& pushConstants,
                                            const uint32_t offset ) const noexcept {
-    m_commandBuffer.pushConstants( layout, shaderStages, offset, sizeof( ve::PushConstants ), &pushConstants );
+    static constexpr uint32_t size{ sizeof( ve::PushConstants ) };
+    static_assert( size <= BoundState::maxPushConstantsSize );
+
+    useLayout( layout );
+    auto& state{ *m_state };
+    if ( isRedundant( state.pushConstantsStages == shaderStages && state.pushConstantsOffset == offset &&
+                      state.pushConstantsSize == size &&
+                      std::memcmp( std::data( state.pushConstants ), &pushConstants, size ) == 0 ) )
+        return;
+
+    state.pushConstantsStages = shaderStages;
+    state.pushConstantsOffset = offset;
+    state.pushConstantsSize   = size;
+    std::memcpy( std::data( state.pushConstants ), &pushConstants, size );
+    m_commandBuffer.pushConstants( layout, shaderStages, offset, size, &pushConstants );
 }
 
 void GraphicsCommandBuffer::beginRendering( const vk::Extent2D extent, const vk::ImageView sampledImageView,
@@ -172,4 +294,27 @@ void GraphicsCommandBuffer::endRendering() const {
     m_commandBuffer.endRendering();
 }
 
+bool GraphicsCommandBuffer::isRedundant( const bool isBound ) const noexcept {
+    if constexpr ( cfg::command::stateFiltering ) {
+        if ( isBound ) {
+            m_state->stats.skippedBinds++;
+            return true;
+        }
+    }
+
+    m_state->stats.issuedBinds++;
+    return false;
+}
+
+void GraphicsCommandBuffer::useLayout( const vk::PipelineLayout layout ) const noexcept {
+    // sets and push constants of another layout may be disturbed, so nothing tracked with it is trusted anymore
+    auto& state{ *m_state };
+    if ( state.layout == layout )
+        return;
+
+    state.layout = layout;
+    state.descriptorSets.fill( vk::DescriptorSet{} );
+    state.pushConstantsSize = 0U;
+}
+
 } // namespace ve
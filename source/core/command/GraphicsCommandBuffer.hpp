@@ -2,37 +2,80 @@
 
 #include "BaseCommandBuffer.hpp"
 
+#include <array>
+#include <cstddef>
+#include <memory>
+
 namespace ve {
 
 class LogicalDevice;
 struct PushConstants;
 
+// Remembers the state bound while recording and drops binds and push constants which would not change it. The
+// state is shared by all copies of a command buffer and forgotten on begin and reset.
 class GraphicsCommandBuffer : public BaseCommandBuffer {
 public:
     using BaseCommandBuffer::BaseCommandBuffer;
     using BaseCommandBuffer::operator=;
 
+    // binds and push constants since the last begin or reset
+    struct StateStats {
+        uint32_t issuedBinds{};
+        uint32_t skippedBinds{};
+    };
+
     static uint32_t getQueueFamilyID( const ve::LogicalDevice& logicalDevice );
 
+    void begin( const vk::CommandBufferUsageFlags flags = {} ) const;
+    void reset() const;
+    StateStats getStateStats() const noexcept { return m_state->stats; }
+
     void bindPipeline( const vk::Pipeline pipeline ) const noexcept;
     void setViewport( const vk::Viewport viewport ) const noexcept;
     void setScissor( const vk::Rect2D scissor ) const noexcept;
     void bindVertexBuffer( const vk::Buffer vertexBuffer ) const;
-    void bindIndexBuffer( const vk::Buffer indexBuffer ) const;
+    void bindIndexBuffer( const vk::Buffer indexBuffer, const vk::IndexType indexType = vk::IndexType::eUint32,
+                          const vk::DeviceSize offset = 0U ) const;
     void bindDescriptorSet( const vk::PipelineLayout pipelineLayout, const vk::DescriptorSet descriptorSet,
                             const uint32_t firstSet = 0U ) const noexcept;
     void drawVertices( const uint32_t firstVertex, const uint32_t vertexCount ) const noexcept;
-    void drawIndices( const uint32_t firstIndex, const uint32_t indicesCount ) const noexcept;
+    void drawIndices( const uint32_t firstIndex, const uint32_t indicesCount,
+                      const uint32_t instanceCount = 1U ) const noexcept;
     void transitionImageLayout( const vk::Image image, const vk::Format format, const vk::ImageLayout oldLayout,
                                 const vk::ImageLayout newLayout, const uint32_t mipLevel = 1U,
                                 const uint32_t layerCount = 1U ) const;
     void copyBufferToImage( const vk::Buffer buffer, const vk::Image image, const vk::Extent2D extent,
-                            const uint32_t layerCount = 1U );
+                            const uint32_t layerCount = 1U, const vk::DeviceSize bufferOffset = 0U,
+                            const uint32_t mipLevel = 0U );
+    void generateMipmaps( const vk::Image image, const vk::Extent2D extent, const uint32_t mipLevels ) const;
     void pushConstants( const vk::PipelineLayout layout, const vk::ShaderStageFlags shaderStages,
                         const ve::PushConstants& pushConstants, const uint32_t offset = 0U ) const noexcept;
     void beginRendering( const vk::Extent2D extent, const vk::ImageView sampledImageView,
                          const vk::ImageView resolvedImageView, const vk::ImageView depthView ) const;
     void endRendering() const;
+
+private:
+    struct BoundState {
+        static constexpr size_t maxDescriptorSets{ 4U };
+        static constexpr size_t maxPushConstantsSize{ 128U }; // smallest limit a device may report
+
+        vk::Pipeline pipeline{};
+        vk::PipelineLayout layout{}; // of the tracked descriptor sets and push constants
+        std::array< vk::DescriptorSet, maxDescriptorSets > descriptorSets{};
+        vk::Buffer indexBuffer{};
+        vk::IndexType indexType{ vk::IndexType::eUint32 };
+        vk::DeviceSize indexBufferOffset{};
+        vk::ShaderStageFlags pushConstantsStages{};
+        uint32_t pushConstantsOffset{};
+        uint32_t pushConstantsSize{};
+        std::array< std::byte, maxPushConstantsSize > pushConstants{};
+        StateStats stats{};
+    };
+
+    std::shared_ptr< BoundState > m_state{ std::make_shared< BoundState >() };
+
+    bool isRedundant( const bool isBound ) const noexcept;
+    void useLayout( const vk::PipelineLayout layout ) const noexcept;
 };
 
 } // namespace ve
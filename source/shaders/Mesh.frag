@@ -9,6 +9,8 @@ layout( location = 2 ) in vec2 inTexCoords;
 
 layout( location = 0 ) out vec4 outFragColor;
 
+layout( constant_id = 1 ) const bool alphaTest = false;
+
 const float PI = 3.14159265359;
 
 float distributionGGX( float normalHalfwayDotMax, float roughness ) {
@@ -40,7 +42,9 @@ vec3 lightColors[ 4 ]    = vec3[]( vec3( 5.0f, 3.0f, 7.0f ), vec3( 3.0f, 5.0f, 3
                                 vec3( 3.0f, 9.0f, 4.0f ), vec3( 13.0f, 5.0f, 5.0f ) );
 
 vec3 getNormalFromMap() {
-    vec3 tangentNormal = texture( normalMap, inTexCoords ).xyz * 2.0 - 1.0;
+    // z is reconstructed, so two channel (BC5) normal maps work the same as RGBA ones
+    vec2 tangentNormalXY = texture( normalMap, inTexCoords ).xy * 2.0 - 1.0;
+    vec3 tangentNormal   = vec3( tangentNormalXY, sqrt( max( 1.0 - dot( tangentNormalXY, tangentNormalXY ), 0.0 ) ) );
 
     vec3 Q1  = dFdx( inWorldPos );
     vec3 Q2  = dFdy( inWorldPos );
@@ -56,6 +60,10 @@ vec3 getNormalFromMap() {
 }
 
 void main() {
+    float alpha = texture( albedoMap, inTexCoords ).a * materialData.colorFactors.a;
+    if ( alphaTest && alpha < materialData.alphaFactors.x )
+        discard;
+
     float metallic  = texture( metallicRoughnessMap, inTexCoords ).b * materialData.metallicRoughnessFactors.x;
     float roughness = texture( metallicRoughnessMap, inTexCoords ).g * materialData.metallicRoughnessFactors.y;
     vec3 albedo     = texture( albedoMap, inTexCoords ).rgb;
@@ -96,5 +104,5 @@ void main() {
     vec3 ambient = vec3( 0.03 ) * albedo;
     vec3 color   = ambient + outRadiance;
     color        = color / ( color + vec3( 1.0 ) );
-    outFragColor = vec4( color, 1.0 );
+    outFragColor = vec4( color, alpha );
 }
\ No newline at end of file
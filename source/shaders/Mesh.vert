@@ -9,6 +9,9 @@ layout( location = 0 ) out vec3 outWorldPos;
 layout( location = 1 ) out vec3 outNormal;
 layout( location = 2 ) out vec2 outTexCoords;
 
+// set by the engine to match cfg::geometry::packedVertices
+layout( constant_id = 0 ) const bool packedVertices = false;
+
 struct Vertex {
     vec3 position;
     float uv_x;
@@ -18,25 +21,75 @@ struct Vertex {
     vec4 tangent;
 };
 
+// ve::PackedVertex, see Vertex.hpp for the encoding
+struct PackedVertex {
+    uint positionXY;
+    uint positionZ;
+    uint normal;
+    uint tangent;
+    uint uv;
+};
+
 layout( buffer_reference, std430 ) readonly buffer VertexBuffer {
     Vertex vertices[];
 };
 
+layout( buffer_reference, std430 ) readonly buffer PackedVertexBuffer {
+    PackedVertex vertices[];
+};
+
+// EXT_mesh_gpu_instancing transforms, slot 0 of the scene buffer is identity for nodes without instances
+layout( buffer_reference, std430 ) readonly buffer InstanceBuffer {
+    mat4 transforms[];
+};
+
 layout( push_constant ) uniform constants {
     mat4 renderMartix;
+    vec4 positionOffset;
+    vec4 positionScale;
     VertexBuffer vertexBuffer;
+    InstanceBuffer instanceBuffer;
 }
 pushConstants;
 
+vec3 octDecode( vec2 encoded ) {
+    vec3 direction = vec3( encoded, 1.0f - abs( encoded.x ) - abs( encoded.y ) );
+    float fold     = max( -direction.z, 0.0f );
+    direction.xy += vec2( direction.x >= 0.0f ? -fold : fold, direction.y >= 0.0f ? -fold : fold );
+    return normalize( direction );
+}
+
+Vertex unpackVertex( PackedVertex packed ) {
+    vec2 positionZ = unpackUnorm2x16( packed.positionZ );
+    vec3 position  = vec3( unpackUnorm2x16( packed.positionXY ), positionZ.x );
+    vec2 uv        = unpackHalf2x16( packed.uv );
+
+    Vertex vertex;
+    vertex.position = pushConstants.positionOffset.xyz + pushConstants.positionScale.xyz * position;
+    vertex.normal   = octDecode( unpackSnorm2x16( packed.normal ) );
+    vertex.uv_x     = uv.x;
+    vertex.uv_y     = uv.y;
+    vertex.color    = vec4( 1.0f );
+    vertex.tangent  = vec4( octDecode( unpackSnorm2x16( packed.tangent ) ), positionZ.y * 2.0f - 1.0f );
+    return vertex;
+}
+
+Vertex fetchVertex() {
+    if ( packedVertices )
+        return unpackVertex( PackedVertexBuffer( pushConstants.vertexBuffer ).vertices[ gl_VertexIndex ] );
+
+    return pushConstants.vertexBuffer.vertices[ gl_VertexIndex ];
+}
+
 void main() {
-    Vertex vertex = pushConstants.vertexBuffer.vertices[ gl_VertexIndex ];
+    Vertex vertex  = fetchVertex();
+    mat4 transform = pushConstants.renderMartix * pushConstants.instanceBuffer.transforms[ gl_InstanceIndex ];
+
+    outWorldPos  = mat3( sceneData.model * transform ) * vertex.position;
 
-    outWorldPos  = mat3( sceneData.model * pushConstants.renderMartix ) * vertex.position;
-    
     //only for uniform scaling
-    outNormal    = mat3( sceneData.model * pushConstants.renderMartix ) * vertex.normal;
+    outNormal    = mat3( sceneData.model * transform ) * vertex.normal;
     outTexCoords = vec2( vertex.uv_x, vertex.uv_y );
 
-    gl_Position = sceneData.projection * sceneData.view * sceneData.model * pushConstants.renderMartix *
-                  vec4( vertex.position, 1.0f );
+    gl_Position = sceneData.projection * sceneData.view * sceneData.model * transform * vec4( vertex.position, 1.0f );
 }
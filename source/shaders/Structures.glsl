@@ -13,6 +13,7 @@ sceneData;
 layout( set = 1, binding = 0 ) uniform GLTFMaterialData {
     vec4 colorFactors;
     vec4 metallicRoughnessFactors;
+    vec4 alphaFactors;
 }
 materialData;
 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ve::utils {
+
+// Stable LSD radix sort by a 64-bit key, one byte per pass. Passes over bytes which are equal for all values are
+// skipped, so keys with few distinct high bits cost only the passes they need. scratch is reused between calls.
+template < typename Value, typename KeyFunction >
+void radixSort( std::vector< Value >& values, std::vector< Value >& scratch, KeyFunction getKey ) {
+    static constexpr size_t radix{ 256U };
+    static constexpr size_t passesCount{ sizeof( uint64_t ) };
+
+    if ( std::size( values ) < 2U )
+        return;
+
+    std::array< std::array< size_t, radix >, passesCount > histograms{};
+    for ( const auto& value : values ) {
+        const uint64_t key{ getKey( value ) };
+        for ( size_t pass{ 0U }; pass < passesCount; pass++ )
+            histograms[ pass ][ ( key >> ( pass * 8U ) ) & 0xFFU ]++;
+    }
+
+    scratch.resize( std::size( values ) );
+    for ( size_t pass{ 0U }; pass < passesCount; pass++ ) {
+        auto& histogram{ histograms[ pass ] };
+        if ( std::ranges::find( histogram, std::size( values ) ) != std::end( histogram ) )
+            continue;
+
+        size_t offset{};
+        for ( auto& count : histogram )
+            offset += std::exchange( count, offset );
+
+        for ( const auto& value : values )
+            scratch[ histogram[ ( getKey( value ) >> ( pass * 8U ) ) & 0xFFU ]++ ] = value;
+
+        std::swap( values, scratch );
+    }
+}
+
+} // namespace ve::utils
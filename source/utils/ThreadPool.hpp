@@ -0,0 +1,74 @@
+#pragma once
+
+#include "NonCopyable.hpp"
+#include "NonMovable.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ve::utils {
+
+class ThreadPool : public NonCopyable,
+                   public NonMovable {
+public:
+    explicit ThreadPool( const uint32_t threadsCount = defaultThreadsCount() ) {
+        m_workers.reserve( threadsCount );
+        for ( uint32_t threadID{ 0U }; threadID < threadsCount; threadID++ )
+            m_workers.emplace_back( [ this ]( const std::stop_token stopToken ) { work( stopToken ); } );
+    }
+
+    template < typename Function >
+    auto submit( Function&& function ) -> std::future< std::invoke_result_t< Function > > {
+        using Result = std::invoke_result_t< Function >;
+
+        auto task{ std::make_shared< std::packaged_task< Result() > >( std::forward< Function >( function ) ) };
+        auto future{ task->get_future() };
+        {
+            const std::scoped_lock lock{ m_mutex };
+            m_tasks.emplace( [ task ]() { ( *task )(); } );
+        }
+        m_condition.notify_one();
+
+        return future;
+    }
+
+    uint32_t size() const noexcept { return static_cast< uint32_t >( std::size( m_workers ) ); }
+
+    static uint32_t defaultThreadsCount() noexcept {
+        return std::max( std::thread::hardware_concurrency(), 2U ) - 1U;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable_any m_condition;
+    std::queue< std::function< void() > > m_tasks;
+
+    // declared last, so workers are stopped and joined before the queue is destroyed
+    std::vector< std::jthread > m_workers;
+
+    void work( const std::stop_token stopToken ) {
+        while ( !stopToken.stop_requested() ) {
+            std::function< void() > task;
+            {
+                std::unique_lock lock{ m_mutex };
+                if ( !m_condition.wait( lock, stopToken, [ this ] { return !m_tasks.empty(); } ) )
+                    return;
+
+                task = std::move( m_tasks.front() );
+                m_tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+} // namespace ve::utils